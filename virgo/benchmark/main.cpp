@@ -0,0 +1,624 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "boundingVolumeHierarchy.h"
+#include "intersectionChecker.h"
+#include "vertexWelder.h"
+#include "data.h"
+#include "file.h"
+#include "offscreenContext.h"
+#include "parallel.h"
+#include "renderer.h"
+#include "spatialReorderer.h"
+#include "tetrahedralMeshGenerator.h"
+#include "timer.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <GL\freeglut.h>
+#include <GL\GL.h>
+
+USE_VIRGO_NAMESPACE
+
+using namespace std;
+
+struct Settings {
+    Settings() : directory("../obj"), output("benchmark.json"), temporary("benchmark.tmp.obj"),
+        maximumTriangleCount(10000000), repeatCount(3), queryCount(100000), tetrahedralize(true),
+        render(true), hierarchy(true), reorder(true) {
+        ratios.push_back(2.0f);
+        ratios.push_back(1.6f);
+        ratios.push_back(1.4f);
+    }
+
+    string directory;
+    string output;
+    string temporary;
+
+    size_t maximumTriangleCount;
+    size_t repeatCount;
+    size_t queryCount;
+
+    vector<float> ratios;
+
+    bool tetrahedralize;
+    bool render;
+    bool hierarchy;
+    bool reorder;
+};
+
+static const char * models[] = { "bull", "hand", "helmet", "scene", "trex" };
+
+static double best(const vector<double> & times) {
+    return times.empty() ? 0 : *min_element(times.begin(), times.end());
+}
+
+static bool readGeometry(const string & filename, Geometry * geometry, FileStatistics & statistics) {
+    File file;
+    file.open(filename.c_str(), FileMode::Read);
+
+    if (!file.isOpen())
+        return false;
+
+    bool status = file.read(geometry);
+    statistics = file.getStatistics();
+    file.close();
+
+    return status;
+}
+
+static bool writeGeometry(const string & filename, const Geometry * geometry) {
+    File file;
+    file.open(filename.c_str(), FileMode::Write);
+
+    if (!file.isOpen())
+        return false;
+
+    bool status = file.write(geometry);
+    file.close();
+
+    return status;
+}
+
+static void tileGeometry(const Geometry * source, size_t tileCount, Geometry * geometry) {
+    Vector minimum(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector maximum(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    const Vector * point = source->getPointData();
+
+    for (size_t i = 0; i < source->getVertexCount(); i++, point++) {
+        minimum.x = min(minimum.x, point->x);
+        minimum.y = min(minimum.y, point->y);
+        minimum.z = min(minimum.z, point->z);
+
+        maximum.x = max(maximum.x, point->x);
+        maximum.y = max(maximum.y, point->y);
+        maximum.z = max(maximum.z, point->z);
+    }
+
+    Vector size = (maximum - minimum) * 1.1f;
+    size_t columnCount = (size_t)ceil(sqrt((double)tileCount));
+
+    for (size_t i = 0; i < tileCount; i++) {
+        size_t offset = geometry->getVertexCount();
+        Vector translation(size.x * (i % columnCount), 0, size.z * (i / columnCount));
+
+        geometry->merge(source);
+
+        for (size_t j = offset; j < geometry->getVertexCount(); j++)
+            geometry->points[j] += translation;
+    }
+}
+
+static void writeTime(FILE * file, const char * name, double time, bool last = false) {
+    fprintf(file, "\"%s\": %.6f%s", name, time, last ? "" : ", ");
+}
+
+static void benchmarkHierarchy(FILE * output, const Settings & settings, const Geometry * geometry) {
+    BoundingVolumeHierarchy hierarchy;
+    vector<double> buildTimes, refitTimes;
+
+    Timer timer;
+
+    for (size_t i = 0; i < settings.repeatCount; i++) {
+        timer.reset();
+        hierarchy.build(geometry);
+        buildTimes.push_back(timer.getElapsedTime());
+    }
+
+    for (size_t i = 0; i < settings.repeatCount; i++) {
+        timer.reset();
+        hierarchy.refit();
+        refitTimes.push_back(timer.getElapsedTime());
+    }
+
+    BoundingBox bounds = hierarchy.getBounds();
+    Vector center = bounds.center();
+    float radius = (bounds.max - bounds.min).length();
+
+    mt19937 generator(1);
+    uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    vector<Ray> rays(settings.queryCount);
+    vector<Vector> points(settings.queryCount);
+
+    for (size_t i = 0; i < settings.queryCount; i++) {
+        Vector direction(distribution(generator), distribution(generator), distribution(generator));
+        Vector target(distribution(generator), distribution(generator), distribution(generator));
+        Vector point(distribution(generator), distribution(generator), distribution(generator));
+
+        rays[i].origin = center + direction.normalized() * radius;
+        rays[i].direction = (center + target * radius * 0.3f - rays[i].origin).normalized();
+
+        points[i] = center + point * radius * 0.6f;
+    }
+
+    size_t hitCount = 0;
+
+    timer.reset();
+
+    for (size_t i = 0; i < rays.size(); i++) {
+        RayHit hit;
+
+        if (hierarchy.intersect(rays[i], hit))
+            hitCount++;
+    }
+
+    double rayTime = timer.getElapsedTime();
+
+    timer.reset();
+
+    for (size_t i = 0; i < points.size(); i++) {
+        SurfacePoint surfacePoint;
+        hierarchy.findClosestPoint(points[i], surfacePoint);
+    }
+
+    double pointTime = timer.getElapsedTime();
+
+    fprintf(output, ",\n      \"hierarchy\": {\"build\": %.6f, \"refit\": %.6f, \"nodes\": %zu, "
+        "\"depth\": %zu, \"size\": %.3f,\n        \"rays\": %zu, \"hits\": %zu, \"rayThroughput\": %.0f, "
+        "\"closestPointThroughput\": %.0f}", best(buildTimes), best(refitTimes), hierarchy.getNodeCount(),
+        hierarchy.getDepth(), hierarchy.getMemoryUsage() / 1048576.0, rays.size(), hitCount,
+        rayTime > 0 ? rays.size() / rayTime : 0, pointTime > 0 ? points.size() / pointTime : 0);
+}
+
+static void benchmarkIntersections(FILE * output, const Settings & settings, const Geometry * geometry) {
+    IntersectionChecker checker;
+    vector<double> times;
+    size_t intersectionCount = 0;
+
+    Timer timer;
+
+    for (size_t i = 0; i < settings.repeatCount; i++) {
+        intersectionCount = 0;
+        timer.reset();
+
+        for (size_t j = 0; j < geometry->getMeshCount(); j++) {
+            checker.checkMesh(geometry, j);
+            intersectionCount += checker.getIntersectionCount();
+        }
+
+        times.push_back(timer.getElapsedTime());
+    }
+
+    fprintf(output, ",\n      \"intersections\": {\"time\": %.6f, \"pairs\": %zu}", best(times), intersectionCount);
+}
+
+static void benchmarkWelding(FILE * output, const Settings & settings, const Geometry * geometry) {
+    VertexWelder welder;
+    vector<double> times;
+
+    Timer timer;
+
+    for (size_t i = 0; i < settings.repeatCount; i++) {
+        Geometry * copy = new Geometry;
+        copy->merge(geometry);
+
+        timer.reset();
+        welder.weldGeometry(copy);
+        times.push_back(timer.getElapsedTime());
+
+        delete copy;
+    }
+
+    fprintf(output, ",\n      \"weld\": {\"time\": %.6f, \"vertices\": %zu, \"degenerate\": %zu, "
+        "\"duplicates\": %zu}", best(times), welder.getRemovedVertexCount(), welder.getDegenerateCount(),
+        welder.getDuplicateCount());
+}
+
+static double measureExtraction(const Settings & settings, const Geometry * geometry, bool indexed) {
+    vector<Vector> points;
+    vector<Triangle> triangles;
+    vector<double> times;
+
+    Timer timer;
+
+    for (size_t i = 0; i < settings.repeatCount; i++) {
+        timer.reset();
+
+        for (size_t j = 0; j < geometry->getMeshCount(); j++) {
+            points.clear();
+            triangles.clear();
+
+            if (indexed)
+                geometry->getIndexedMeshDataByIndex(j, points, triangles);
+            else
+                geometry->getMeshDataByIndex(j, points, triangles);
+        }
+
+        times.push_back(timer.getElapsedTime());
+    }
+
+    return best(times);
+}
+
+static void benchmarkReordering(FILE * output, const Settings & settings, const Geometry * geometry) {
+    static const VertexOrdering orderings[] = { VertexOrdering::FileOrdering,
+        VertexOrdering::MortonOrdering, VertexOrdering::HilbertOrdering };
+    static const char * names[] = { "file", "morton", "hilbert" };
+
+    SpatialReorderer reorderer;
+    OffscreenContext context;
+
+    bool render = settings.render && context.create(64, 64);
+
+    Timer timer;
+
+    fprintf(output, ",\n      \"reorder\": [");
+
+    for (size_t i = 0; i < sizeof(orderings) / sizeof(orderings[0]); i++) {
+        vector<double> reorderTimes, weldTimes, renderTimes, hierarchyTimes, intersectionTimes;
+
+        Geometry * reordered = nullptr;
+        reorderer.setOrdering(orderings[i]);
+
+        for (size_t j = 0; j < settings.repeatCount; j++) {
+            delete reordered;
+
+            reordered = new Geometry;
+            reordered->merge(geometry);
+
+            timer.reset();
+            reorderer.reorderGeometry(reordered);
+            reorderTimes.push_back(timer.getElapsedTime());
+        }
+
+        double extractTime = measureExtraction(settings, reordered, false);
+        double indexedTime = measureExtraction(settings, reordered, true);
+
+        VertexWelder welder;
+
+        for (size_t j = 0; j < settings.repeatCount; j++) {
+            Geometry * copy = new Geometry;
+            copy->merge(reordered);
+
+            timer.reset();
+            welder.weldGeometry(copy);
+            weldTimes.push_back(timer.getElapsedTime());
+
+            delete copy;
+        }
+
+        if (render) {
+            Renderer renderer;
+            renderer.initialize(OffscreenContext::getProcedure);
+
+            for (size_t j = 0; j < settings.repeatCount; j++) {
+                renderer.clear();
+                timer.reset();
+
+                renderer.load(reordered);
+                glFinish();
+
+                renderTimes.push_back(timer.getElapsedTime());
+            }
+
+            renderer.clear();
+        }
+
+        if (settings.hierarchy) {
+            BoundingVolumeHierarchy hierarchy;
+            IntersectionChecker checker;
+
+            for (size_t j = 0; j < settings.repeatCount; j++) {
+                timer.reset();
+                hierarchy.build(reordered);
+                hierarchyTimes.push_back(timer.getElapsedTime());
+
+                timer.reset();
+
+                for (size_t k = 0; k < reordered->getMeshCount(); k++)
+                    checker.checkMesh(reordered, k);
+
+                intersectionTimes.push_back(timer.getElapsedTime());
+            }
+        }
+
+        fprintf(output, "%s\n        {\"ordering\": \"%s\", ", i != 0 ? "," : "", names[i]);
+        writeTime(output, "time", best(reorderTimes));
+        writeTime(output, "extract", extractTime);
+        writeTime(output, "indexedExtract", indexedTime);
+        writeTime(output, "weld", best(weldTimes));
+        writeTime(output, "renderBuild", best(renderTimes));
+        writeTime(output, "hierarchyBuild", best(hierarchyTimes));
+        writeTime(output, "intersections", best(intersectionTimes), true);
+        fprintf(output, "}");
+
+        delete reordered;
+    }
+
+    fprintf(output, "\n      ]");
+}
+
+static void benchmarkModel(FILE * output, const Settings & settings, const string & name,
+    size_t scale, const Geometry * source, bool & first) {
+    FileStatistics statistics;
+    vector<double> parseTimes, writeTimes;
+
+    Timer timer;
+
+    if (!writeGeometry(settings.temporary, source))
+        return;
+
+    for (size_t i = 0; i < settings.repeatCount; i++) {
+        timer.reset();
+        writeGeometry(settings.temporary, source);
+        writeTimes.push_back(timer.getElapsedTime());
+    }
+
+    Geometry * geometry = nullptr;
+
+    for (size_t i = 0; i < settings.repeatCount; i++) {
+        delete geometry;
+        geometry = new Geometry;
+
+        readGeometry(settings.temporary, geometry, statistics);
+        parseTimes.push_back(statistics.time);
+    }
+
+    remove(settings.temporary.c_str());
+
+    double fileSize = statistics.size / 1048576.0;
+
+    fprintf(output, "%s\n    {\"model\": \"%s\", \"scale\": %zu, \"vertices\": %zu, \"triangles\": %zu, "
+        "\"meshes\": %zu, \"fileSize\": %.3f,\n      ", first ? "" : ",", name.c_str(), scale,
+        geometry->getVertexCount(), geometry->getPolygonCount(), geometry->getMeshCount(), fileSize);
+
+    writeTime(output, "parse", best(parseTimes));
+    fprintf(output, "\"parseThroughput\": %.3f, ", best(parseTimes) > 0 ? fileSize / best(parseTimes) : 0);
+    writeTime(output, "write", best(writeTimes));
+    fprintf(output, "\"writeThroughput\": %.3f,\n      ", best(writeTimes) > 0 ? fileSize / best(writeTimes) : 0);
+    writeTime(output, "extract", measureExtraction(settings, geometry, false));
+    writeTime(output, "indexedExtract", measureExtraction(settings, geometry, true), true);
+
+    first = false;
+
+    benchmarkWelding(output, settings, geometry);
+
+    if (settings.render) {
+        OffscreenContext context;
+
+        if (context.create(64, 64)) {
+            Renderer renderer;
+            renderer.initialize(OffscreenContext::getProcedure);
+
+            vector<double> renderTimes, reloadTimes, updateTimes;
+
+            for (size_t i = 0; i < settings.repeatCount; i++) {
+                renderer.clear();
+                timer.reset();
+
+                renderer.load(geometry);
+                glFinish();
+
+                renderTimes.push_back(timer.getElapsedTime());
+            }
+
+            for (size_t i = 0; i < settings.repeatCount; i++) {
+                renderer.release();
+                timer.reset();
+
+                renderer.load(geometry);
+                glFinish();
+
+                reloadTimes.push_back(timer.getElapsedTime());
+            }
+
+            for (size_t i = 0; i < settings.repeatCount && geometry->getMeshCount() != 0; i++) {
+                geometry->invalidateMesh(0);
+                timer.reset();
+
+                renderer.load(geometry);
+                glFinish();
+
+                updateTimes.push_back(timer.getElapsedTime());
+            }
+
+            fprintf(output, ",\n      \"renderBuild\": {\"time\": %.6f, \"coldTime\": %.6f, \"reloadTime\": %.6f, "
+                "\"updateTime\": %.6f, \"updatedMeshes\": %zu, \"buffers\": %s, \"size\": %.3f, "
+                "\"initialAcmr\": %.3f, \"acmr\": %.3f}", best(renderTimes), renderTimes.front(), best(reloadTimes),
+                best(updateTimes), renderer.getUpdatedMeshCount(), renderer.hasBuffers() ? "true" : "false",
+                renderer.getBufferSize() / 1048576.0, renderer.getInitialCacheMissRatio(),
+                renderer.getCacheMissRatio());
+
+            renderer.clear();
+        }
+    }
+
+    if (settings.hierarchy) {
+        benchmarkHierarchy(output, settings, geometry);
+        benchmarkIntersections(output, settings, geometry);
+    }
+
+    if (settings.reorder)
+        benchmarkReordering(output, settings, geometry);
+
+    if (settings.tetrahedralize && scale == 1) {
+        TetrahedralMeshGenerator generator;
+
+        fprintf(output, ",\n      \"tetrahedralize\": [");
+
+        for (size_t i = 0; i < settings.ratios.size(); i++) {
+            vector<double> times;
+            size_t tetrahedronCount = 0;
+            bool status = true;
+
+            for (size_t j = 0; j < settings.repeatCount && status; j++) {
+                Geometry * copy = new Geometry;
+                copy->merge(geometry);
+
+                timer.reset();
+
+                try {
+                    for (size_t k = 0; k < copy->getMeshCount(); k++)
+                        generator.tetrahedralizeMesh(copy, k, settings.ratios[i]);
+                }
+                catch (...) {
+                    status = false;
+                }
+
+                times.push_back(timer.getElapsedTime());
+                tetrahedronCount = copy->getTetrahedronCount();
+
+                delete copy;
+            }
+
+            fprintf(output, "%s\n        {\"ratio\": %.3f, \"time\": %.6f, \"tetrahedra\": %zu, \"status\": \"%s\"}",
+                i != 0 ? "," : "", settings.ratios[i], best(times), tetrahedronCount, status ? "ok" : "failed");
+        }
+
+        fprintf(output, "\n      ]");
+    }
+
+    fprintf(output, "}");
+    fflush(output);
+
+    fprintf(stderr, "%s x%zu: %zu triangles, parse %.3f s, write %.3f s\n", name.c_str(), scale,
+        geometry->getPolygonCount(), best(parseTimes), best(writeTimes));
+
+    delete geometry;
+}
+
+int main(int argc, char ** argv) {
+    Settings settings;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+
+        if (strcmp(argv[i], "--models") == 0 && hasValue)
+            settings.directory = argv[++i];
+        else if (strcmp(argv[i], "--output") == 0 && hasValue)
+            settings.output = argv[++i];
+        else if (strcmp(argv[i], "--temporary") == 0 && hasValue)
+            settings.temporary = argv[++i];
+        else if (strcmp(argv[i], "--max-triangles") == 0 && hasValue)
+            settings.maximumTriangleCount = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--repeat") == 0 && hasValue)
+            settings.repeatCount = max<size_t>(1, strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--ratios") == 0 && hasValue) {
+            settings.ratios.clear();
+
+            for (char * token = strtok(argv[++i], ","); token != nullptr; token = strtok(nullptr, ","))
+                settings.ratios.push_back((float)atof(token));
+        }
+        else if (strcmp(argv[i], "--no-tetrahedralize") == 0)
+            settings.tetrahedralize = false;
+        else if (strcmp(argv[i], "--queries") == 0 && hasValue)
+            settings.queryCount = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--no-render") == 0)
+            settings.render = false;
+        else if (strcmp(argv[i], "--no-hierarchy") == 0)
+            settings.hierarchy = false;
+        else if (strcmp(argv[i], "--no-reorder") == 0)
+            settings.reorder = false;
+        else {
+            fprintf(stderr, "Usage: benchmark [--models dir] [--output file] [--temporary file] "
+                "[--max-triangles N] [--repeat N] [--queries N] [--ratios r1,r2,...] [--no-tetrahedralize] "
+                "[--no-render] [--no-hierarchy] [--no-reorder]\n");
+            return 1;
+        }
+    }
+
+    FILE * output = fopen(settings.output.c_str(), "w");
+
+    if (output == nullptr) {
+        fprintf(stderr, "Unable to write file: %s\n", settings.output.c_str());
+        return 1;
+    }
+
+    fprintf(output, "{\n  \"version\": 1,\n  \"threads\": %zu,\n  \"repeat\": %zu,\n  \"results\": [",
+        getThreadCount(), settings.repeatCount);
+
+    bool first = true;
+    int status = 0;
+
+    for (size_t i = 0; i < sizeof(models) / sizeof(models[0]); i++) {
+        string filename = settings.directory + "/" + models[i] + ".obj";
+
+        Geometry * source = new Geometry;
+        FileStatistics statistics;
+
+        if (!readGeometry(filename, source, statistics) || source->getPolygonCount() == 0) {
+            fprintf(stderr, "Unable to open file: %s\n", filename.c_str());
+            delete source;
+
+            status = 1;
+            continue;
+        }
+
+        size_t triangleCount = source->getPolygonCount();
+
+        for (size_t target = triangleCount; target <= settings.maximumTriangleCount; target *= 10) {
+            size_t scale = target / triangleCount;
+
+            if (scale == 1) {
+                benchmarkModel(output, settings, models[i], 1, source, first);
+            }
+            else {
+                Geometry * tiled = new Geometry;
+                tileGeometry(source, scale, tiled);
+
+                benchmarkModel(output, settings, models[i], scale, tiled, first);
+
+                delete tiled;
+            }
+        }
+
+        delete source;
+    }
+
+    fprintf(output, "\n  ]\n}\n");
+    fclose(output);
+
+    return status;
+}
\ No newline at end of file
@@ -30,8 +30,12 @@
 
 #include "namespace.h"
 #include "data.h"
+#include "decimator.h"
 #include "file.h"
+#include "intersectionChecker.h"
+#include "spatialReorderer.h"
 #include "viewport.h"
+#include "task.h"
 #include "tetrahedralMeshGenerator.h"
 #include "translator.h"
 #include <cstdio>
@@ -47,13 +51,32 @@ enum Theme {
     Dark
 };
 
+enum ApplicationState {
+    MainState = 0,
+    OpenState,
+    ImportState,
+    InformationState,
+    ViewportState,
+    TetrahedralizeState,
+    DecimateState,
+    DeleteState,
+    ExportState,
+    SaveState,
+    CloseState,
+    PreferencesState,
+    AboutState,
+    ProgressState,
+    ExitState
+};
+
 struct Preferences {
     Preferences(const Language & = Language::English,
-        const Theme & = Theme::Light);
+        const Theme & = Theme::Light, const VertexOrdering & = VertexOrdering::FileOrdering);
     ~Preferences();
 
     Language language;
     Theme theme;
+    VertexOrdering ordering;
 };
 
 class Application {
@@ -70,12 +93,22 @@ private:
     File file;
     Viewport viewport;
     TetrahedralMeshGenerator generator;
+    Decimator decimator;
+    SpatialReorderer reorderer;
+    IntersectionChecker checker;
     Translator translator;
     Preferences preferences;
+    FileStatistics statistics;
 
     FILE * preferenceFile;
     Geometry * geometry;
 
+    Task task;
+    ApplicationState taskState;
+    Geometry * taskGeometry;
+    string taskFilename;
+    TaskStatus taskStatus;
+
     void createTitle();
     void createMenu(const vector<string> &);
     void setTheme(const Theme &);
@@ -92,21 +125,31 @@ private:
     void separator();
 
     void removeData();
-    void defragmentGeometry();
     bool hasMesh() const;
 
-    void openAction();
-    void importAction();
-    void informationAction();
-    void viewportAction();
-    void tetrahedralizeAction();
-    void deleteAction();
-    void exportAction();
-    void saveAction();
-    void closeAction();
-    void preferencesAction();
-    void aboutAction();
-    void exitAction();
+    void startTask(const ApplicationState &, const function<TaskStatus(Progress *)> &);
+    void completeTask();
+    bool isBusy() const;
+
+    const char * getPhaseName(const ProgressPhase &) const;
+    string getTemporaryFilename(const string &) const;
+
+    bool checkIntersections(size_t, bool);
+
+    ApplicationState mainAction();
+    ApplicationState openAction();
+    ApplicationState importAction();
+    ApplicationState informationAction();
+    ApplicationState viewportAction();
+    ApplicationState tetrahedralizeAction();
+    ApplicationState decimateAction();
+    ApplicationState deleteAction();
+    ApplicationState exportAction();
+    ApplicationState saveAction();
+    ApplicationState closeAction();
+    ApplicationState preferencesAction();
+    ApplicationState aboutAction();
+    ApplicationState progressAction();
 };
 
 VIRGO_NAMESPACE_END
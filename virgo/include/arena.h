@@ -0,0 +1,120 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "namespace.h"
+#include <cstddef>
+#include <new>
+#include <vector>
+
+VIRGO_NAMESPACE_BEGIN
+
+using namespace std;
+
+class Arena {
+public:
+    Arena(size_t = 4 << 20);
+    ~Arena();
+
+    void * allocate(size_t, size_t = 16);
+    void deallocate(void *, size_t);
+
+    void reset();
+    void release();
+
+    size_t getReservedSize() const;
+    size_t getUsedSize() const;
+    size_t getBlockCount() const;
+
+private:
+    struct Block {
+        char * data;
+        size_t size;
+        size_t offset;
+        bool dedicated;
+    };
+
+    vector<Block> blocks;
+    size_t current;
+
+    size_t blockSize;
+    size_t reservedSize;
+    size_t usedSize;
+
+    size_t createBlock(size_t, bool);
+
+    Arena(const Arena &);
+    Arena & operator=(const Arena &);
+};
+
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    ArenaAllocator(Arena * arena = nullptr) : arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> & allocator) : arena(allocator.getArena()) {}
+
+    T * allocate(size_t count) {
+        if (arena == nullptr)
+            return (T *)::operator new(count * sizeof(T));
+
+        return (T *)arena->allocate(count * sizeof(T), alignof(T));
+    }
+
+    void deallocate(T * pointer, size_t count) {
+        if (arena == nullptr)
+            ::operator delete(pointer);
+        else
+            arena->deallocate(pointer, count * sizeof(T));
+    }
+
+    Arena * getArena() const {
+        return arena;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> & allocator) const {
+        return arena == allocator.getArena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> & allocator) const {
+        return arena != allocator.getArena();
+    }
+
+private:
+    Arena * arena;
+};
+
+VIRGO_NAMESPACE_END
+
+#endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "namespace.h"
+#include "data.h"
+#include "decimator.h"
+#include "file.h"
+#include "intersectionChecker.h"
+#include "spatialReorderer.h"
+#include "tetrahedralMeshGenerator.h"
+#include "vertexWelder.h"
+#include <string>
+#include <vector>
+
+VIRGO_NAMESPACE_BEGIN
+
+using namespace std;
+
+enum BatchCommand {
+    Open = 0,
+    Import,
+    Tetrahedralize,
+    Delete,
+    Export,
+    Save,
+    Weld,
+    Decimate,
+    Reorder
+};
+
+struct BatchStep {
+    BatchStep(const BatchCommand & = BatchCommand::Open, const string & = string());
+    ~BatchStep();
+
+    BatchCommand command;
+    string argument;
+
+    double time;
+    bool status;
+};
+
+class Batch {
+public:
+    Batch();
+    ~Batch();
+
+    bool parse(int, char **);
+    bool parse(const vector<string> &);
+    int run();
+    void reset();
+
+    void setVerbose(bool);
+    bool getVerbose() const;
+
+    void setThreadCount(size_t);
+
+    void setDirectory(const string &);
+    const string & getDirectory() const;
+
+    const vector<BatchStep> & getSteps() const;
+    double getTotalTime() const;
+    const string & getError() const;
+    size_t estimateMemory() const;
+
+    static bool isBatch(int, char **);
+    static void printUsage();
+    static const char * getCommandName(const BatchCommand &);
+
+private:
+    vector<BatchStep> steps;
+
+    File file;
+    TetrahedralMeshGenerator generator;
+    IntersectionChecker checker;
+    VertexWelder welder;
+    Decimator decimator;
+    SpatialReorderer reorderer;
+
+    Geometry * geometry;
+    Geometry * scratch;
+
+    string directory;
+
+    bool verbose;
+    double totalTime;
+    string error;
+
+    bool openStep(const string &);
+    bool importStep(const string &);
+    bool tetrahedralizeStep(const string &);
+    bool deleteStep(const string &);
+    bool exportStep(const string &);
+    bool saveStep(const string &);
+    bool weldStep(const string &);
+    bool decimateStep(const string &);
+    bool reorderStep(const string &);
+
+    bool readGeometry(const string &, Geometry *);
+    bool writeGeometry(const string &, const Geometry *);
+    bool findMesh(const string &, size_t &);
+    string getPath(const string &) const;
+    void reportError(const char *, const char *);
+};
+
+VIRGO_NAMESPACE_END
+
+#endif
\ No newline at end of file
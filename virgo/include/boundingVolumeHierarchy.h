@@ -0,0 +1,138 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+#include "namespace.h"
+#include "data.h"
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+#include <OpenEXR\ImathBox.h>
+
+VIRGO_NAMESPACE_BEGIN
+
+using namespace std;
+
+typedef Box<Vector> BoundingBox;
+
+struct Ray {
+    Ray(const Vector & = Vector(0, 0, 0), const Vector & = Vector(0, 0, 1), float = FLT_MAX);
+    ~Ray();
+
+    Vector origin;
+    Vector direction;
+    float distance;
+};
+
+struct Primitive {
+    Primitive(size_t = 0, size_t = 0);
+
+    uint32_t mesh;
+    uint32_t triangle;
+};
+
+struct RayHit {
+    RayHit();
+    ~RayHit();
+
+    Primitive primitive;
+    float distance;
+    float u, v;
+};
+
+struct SurfacePoint {
+    SurfacePoint();
+    ~SurfacePoint();
+
+    Primitive primitive;
+    Vector point;
+    float distance;
+};
+
+struct BoundingVolumeNode {
+    Vector minimum;
+    uint32_t offset;
+    Vector maximum;
+    uint32_t count;
+
+    bool isLeaf() const;
+};
+
+class BoundingVolumeHierarchy {
+public:
+    BoundingVolumeHierarchy();
+    ~BoundingVolumeHierarchy();
+
+    void setThreadCount(size_t);
+    size_t getThreadCount() const;
+
+    void setLeafSize(size_t);
+    size_t getLeafSize() const;
+
+    void build(const Geometry *);
+    void build(const Geometry *, size_t);
+    void refit();
+    void clear();
+
+    bool intersect(const Ray &, RayHit &) const;
+    bool findClosestPoint(const Vector &, SurfacePoint &, float = FLT_MAX) const;
+    void findOverlaps(const BoundingBox &, vector<Primitive> &) const;
+
+    void getTriangle(const Primitive &, Vector &, Vector &, Vector &) const;
+
+    const Geometry * getGeometry() const;
+    BoundingBox getBounds() const;
+
+    const BoundingVolumeNode * getNodeData() const;
+    const Primitive * getPrimitiveData() const;
+
+    size_t getNodeCount() const;
+    size_t getPrimitiveCount() const;
+    size_t getDepth() const;
+    size_t getMemoryUsage() const;
+
+private:
+    const Geometry * geometry;
+
+    vector<BoundingVolumeNode> nodes;
+    vector<Primitive> primitives;
+
+    size_t threadCount;
+    size_t leafSize;
+    size_t depth;
+
+    void buildRange(const Geometry *, size_t, size_t);
+
+    BoundingVolumeHierarchy(const BoundingVolumeHierarchy &);
+    BoundingVolumeHierarchy & operator=(const BoundingVolumeHierarchy &);
+};
+
+VIRGO_NAMESPACE_END
+
+#endif
\ No newline at end of file
@@ -29,6 +29,7 @@
 #define DATA_H
 
 #include "namespace.h"
+#include "arena.h"
 #include <vector>
 #include <string>
 #include <OpenEXR\ImathVec.h>
@@ -45,37 +46,134 @@ typedef Matrix44<float> Matrix;
 
 struct Triangle {
     Triangle(size_t = 0, size_t = 0, size_t = 0);
-    ~Triangle();
 
     size_t v1, v2, v3;
 };
 
+struct Tetrahedron {
+    Tetrahedron(size_t = 0, size_t = 0, size_t = 0, size_t = 0);
+
+    size_t v1, v2, v3, v4;
+};
+
+static_assert(sizeof(Triangle) == 3 * sizeof(size_t) && sizeof(Tetrahedron) == 4 * sizeof(size_t),
+    "Triangle and Tetrahedron arrays are read as flat arrays of vertex indices");
+
+typedef vector<Vector, ArenaAllocator<Vector> > PointArray;
+typedef vector<Triangle, ArenaAllocator<Triangle> > TriangleArray;
+typedef vector<Tetrahedron, ArenaAllocator<Tetrahedron> > TetrahedronArray;
+typedef vector<size_t, ArenaAllocator<size_t> > NeighborArray;
+typedef vector<float, ArenaAllocator<float> > AttributeArray;
+typedef vector<size_t, ArenaAllocator<size_t> > IndexArray;
+
+enum NormalWeighting {
+    AreaWeighting = 0,
+    AngleWeighting
+};
+
+struct TetrahedralMesh {
+    TetrahedralMesh(Arena * = nullptr);
+    ~TetrahedralMesh();
+
+    TetrahedronArray tetrahedra;
+    NeighborArray neighbors;
+    AttributeArray attributes;
+
+    size_t attributeCount;
+
+    const Tetrahedron * getTetrahedronData() const;
+    size_t getTetrahedronCount() const;
+
+    size_t * getIndexData();
+    const size_t * getIndexData() const;
+
+    bool hasNeighbors() const;
+    bool hasAttributes() const;
+
+    void clear();
+};
+
+struct SurfaceNormals {
+    SurfaceNormals(Arena * = nullptr);
+    ~SurfaceNormals();
+
+    PointArray normals;
+    IndexArray indices;
+
+    NormalWeighting weighting;
+    float creaseAngle;
+
+    const Vector * getNormalData() const;
+    size_t getNormalCount() const;
+
+    bool isValid(size_t, const NormalWeighting &, float) const;
+    void clear();
+};
+
 struct Mesh {
-    Mesh();
+    Mesh(Arena * = nullptr);
     ~Mesh();
 
     string name;
-    vector<Triangle *> triangles;
+    TriangleArray triangles;
+    TetrahedralMesh volume;
+    SurfaceNormals normals;
+
+    size_t version;
+
+    const Triangle * getTriangleData() const;
+    size_t getTriangleCount() const;
+
+    size_t * getIndexData();
+    const size_t * getIndexData() const;
 };
 
 struct Geometry {
     Geometry();
     ~Geometry();
 
-    vector<Vector *> points;
-    vector<Mesh *> meshes;
+    Arena arena;
+
+    PointArray points;
+    vector<Mesh *, ArenaAllocator<Mesh *> > meshes;
+
+    size_t version;
+
+    Mesh * createMesh(const string &);
+    void removeMeshByIndex(size_t);
+    void invalidateMesh(size_t);
+    void merge(const Geometry *);
+    void extractMesh(size_t, Geometry *) const;
+    void remapPoints(const vector<size_t> &, size_t);
+    void removeUnusedPoints();
+    void clone(const Geometry *);
+    void clear();
 
     Mesh * getMeshByIndex(size_t) const;
     Mesh * getMeshByName(const char *) const;
 
     void getMeshDataByIndex(size_t,
-        vector<Vector *> &, vector<Triangle *> &) const;
+        vector<Vector> &, vector<Triangle> &) const;
     void getMeshDataByName(const char *,
-        vector<Vector *> &, vector<Triangle *> &) const;
+        vector<Vector> &, vector<Triangle> &) const;
+    void getIndexedMeshDataByIndex(size_t,
+        vector<Vector> &, vector<Triangle> &) const;
+    void getIndexedMeshDataByName(const char *,
+        vector<Vector> &, vector<Triangle> &) const;
+
+    const Vector * getPointData() const;
 
     size_t getVertexCount() const;
     size_t getPolygonCount() const;
+    size_t getTetrahedronCount() const;
     size_t getMeshCount() const;
+
+    size_t getReservedMemory() const;
+    size_t getUsedMemory() const;
+
+private:
+    Geometry(const Geometry &);
+    Geometry & operator=(const Geometry &);
 };
 
 VIRGO_NAMESPACE_END
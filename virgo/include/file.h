@@ -30,7 +30,12 @@
 
 #include "namespace.h"
 #include "data.h"
+#include "mappedFile.h"
+#include "progress.h"
+#include <cstdint>
 #include <fstream>
+#include <string>
+#include <vector>
 
 VIRGO_NAMESPACE_BEGIN
 
@@ -42,6 +47,21 @@ enum FileMode {
     ReadWrite
 };
 
+enum FileFormat {
+    Object = 0,
+    Binary
+};
+
+struct FileStatistics {
+    FileStatistics(size_t = 0, double = 0);
+    ~FileStatistics();
+
+    size_t size;
+    double time;
+
+    double getThroughput() const;
+};
+
 class File {
 public:
     File();
@@ -52,11 +72,42 @@ public:
 
     bool isOpen() const;
 
-    void read(Geometry *) const;
-    void write(const Geometry *);
+    bool read(Geometry *);
+    bool write(const Geometry *);
+
+    void setFormat(const FileFormat &);
+    FileFormat getFormat() const;
+
+    void setPrecision(int);
+    int getPrecision() const;
+
+    void setThreadCount(size_t);
+    size_t getThreadCount() const;
+
+    void setProgress(Progress *);
+    Progress * getProgress() const;
+
+    const FileStatistics & getStatistics() const;
 
 private:
     fstream * file;
+    MappedFile * mappedFile;
+
+    FileFormat format;
+    int precision;
+    size_t threadCount;
+    FileStatistics statistics;
+    Progress * progress;
+
+    void parseObject(const char *, const char *, Geometry *) const;
+    void parseObjectChunks(const char *, const char *, Geometry *, size_t) const;
+    bool parseBinary(const char *, const char *, Geometry *) const;
+
+    void writeObject(const Geometry *);
+    void writeObjectChunks(const Vector *, const Triangle *, size_t);
+    void writeBinary(const Geometry *);
+    void writeBlock(uint64_t &, uint64_t, const void *, size_t);
+    void writeIndices(uint64_t &, uint64_t, const size_t *, size_t, vector<uint64_t> &);
 };
 
 VIRGO_NAMESPACE_END
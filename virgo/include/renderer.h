@@ -0,0 +1,119 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "namespace.h"
+#include "data.h"
+#include "normalGenerator.h"
+#include "vertexCacheOptimizer.h"
+#include <vector>
+
+VIRGO_NAMESPACE_BEGIN
+
+using namespace std;
+
+typedef void (* RendererProcedure)();
+typedef RendererProcedure (* RendererLoader)(const char *);
+
+class Renderer {
+public:
+    Renderer();
+    ~Renderer();
+
+    void initialize(RendererLoader);
+    bool hasBuffers() const;
+
+    void setCacheOptimization(bool);
+    bool getCacheOptimization() const;
+
+    void setNormalWeighting(const NormalWeighting &);
+    NormalWeighting getNormalWeighting() const;
+
+    void setCreaseAngle(float);
+    float getCreaseAngle() const;
+
+    void load(Geometry *);
+    void draw() const;
+    void release();
+    void clear();
+
+    size_t getVertexCount() const;
+    size_t getIndexCount() const;
+    size_t getBufferSize() const;
+
+    float getInitialCacheMissRatio() const;
+    float getCacheMissRatio() const;
+
+    size_t getUpdatedMeshCount() const;
+
+private:
+    struct Vertex {
+        Vector position;
+        Vector normal;
+    };
+
+    struct MeshBuffer {
+        unsigned int vertexBuffer;
+        unsigned int indexBuffer;
+
+        size_t vertexCount;
+        size_t indexCount;
+
+        vector<Vertex> vertices;
+        vector<unsigned int> indices;
+
+        size_t version;
+
+        float initialCacheMissRatio;
+        float cacheMissRatio;
+    };
+
+    vector<MeshBuffer> buffers;
+    bool bufferSupport;
+
+    const Geometry * loadedGeometry;
+    size_t loadedVersion;
+    size_t updatedMeshCount;
+
+    NormalGenerator generator;
+    VertexCacheOptimizer optimizer;
+    bool cacheOptimization;
+
+    void invalidate();
+    void buildMesh(Geometry *, size_t, MeshBuffer &);
+    void uploadMesh(MeshBuffer &) const;
+    void releaseMesh(MeshBuffer &, bool) const;
+
+    void packMesh(const Geometry *, size_t, vector<Vertex> &, vector<unsigned int> &) const;
+    void optimizeMesh(MeshBuffer &);
+};
+
+VIRGO_NAMESPACE_END
+
+#endif
\ No newline at end of file
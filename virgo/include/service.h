@@ -0,0 +1,106 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include "namespace.h"
+#include "batch.h"
+#include "timer.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+VIRGO_NAMESPACE_BEGIN
+
+using namespace std;
+
+class Service {
+public:
+    Service();
+    ~Service();
+
+    void setDirectory(const string &);
+    const string & getDirectory() const;
+
+    void setWorkerCount(size_t);
+    size_t getWorkerCount() const;
+
+    void setMemoryLimit(size_t);
+    size_t getMemoryLimit() const;
+
+    void setPollInterval(size_t);
+    size_t getPollInterval() const;
+
+    void setSingleRun(bool);
+    bool getSingleRun() const;
+
+    int run();
+
+private:
+    struct Job {
+        string name;
+        Timer timer;
+    };
+
+    string directory;
+
+    size_t workerCount;
+    size_t memoryLimit;
+    size_t pollInterval;
+
+    bool singleRun;
+
+    mutex queueMutex;
+    condition_variable queueCondition;
+    condition_variable memoryCondition;
+
+    deque<Job> queue;
+
+    size_t memoryUsage;
+    size_t activeCount;
+    size_t completedCount;
+    size_t failedCount;
+
+    bool stopping;
+
+    void work(size_t);
+    void processJob(Batch &, const Job &, size_t);
+
+    size_t claimJobs();
+    bool listJobs(vector<string> &) const;
+    bool readJob(const string &, vector<string> &) const;
+    bool writeResult(const string &, const Batch &, bool, const string &, double, size_t) const;
+
+    string getPath(const string &) const;
+};
+
+VIRGO_NAMESPACE_END
+
+#endif
\ No newline at end of file
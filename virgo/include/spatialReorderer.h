@@ -0,0 +1,77 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SPATIAL_REORDERER_H
+#define SPATIAL_REORDERER_H
+
+#include "namespace.h"
+#include "data.h"
+#include "progress.h"
+#include <vector>
+
+VIRGO_NAMESPACE_BEGIN
+
+using namespace std;
+
+enum VertexOrdering {
+    FileOrdering = 0,
+    MortonOrdering,
+    HilbertOrdering
+};
+
+class SpatialReorderer {
+public:
+    SpatialReorderer();
+    ~SpatialReorderer();
+
+    void setOrdering(const VertexOrdering &);
+    VertexOrdering getOrdering() const;
+
+    void setThreadCount(size_t);
+    size_t getThreadCount() const;
+
+    void setProgress(Progress *);
+    Progress * getProgress() const;
+
+    void reorderGeometry(Geometry *);
+
+    const vector<size_t> & getRemap() const;
+
+private:
+    vector<size_t> remap;
+
+    VertexOrdering ordering;
+    size_t threadCount;
+    Progress * progress;
+
+    void reorderVertices(Geometry *, size_t);
+    void reorderTriangles(Mesh *, size_t);
+};
+
+VIRGO_NAMESPACE_END
+
+#endif
\ No newline at end of file
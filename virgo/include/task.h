@@ -0,0 +1,80 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef TASK_H
+#define TASK_H
+
+#include "namespace.h"
+#include "progress.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+
+VIRGO_NAMESPACE_BEGIN
+
+using namespace std;
+
+enum TaskStatus {
+    CompletedStatus = 0,
+    CancelledStatus,
+    InvalidStatus,
+    FailedStatus
+};
+
+class Task {
+public:
+    Task();
+    ~Task();
+
+    bool start(const function<TaskStatus(Progress *)> &);
+    void cancel();
+    TaskStatus wait();
+    void detach();
+
+    bool isActive() const;
+    bool isFinished() const;
+
+    const Progress * getProgress() const;
+
+private:
+    struct State {
+        Progress progress;
+        atomic<bool> finished;
+        TaskStatus status;
+    };
+
+    thread worker;
+    shared_ptr<State> state;
+
+    Task(const Task &);
+    Task & operator=(const Task &);
+};
+
+VIRGO_NAMESPACE_END
+
+#endif
\ No newline at end of file
@@ -30,6 +30,10 @@
 
 #include "namespace.h"
 #include "data.h"
+#include "progress.h"
+
+class tetgenio;
+class tetgenbehavior;
 
 VIRGO_NAMESPACE_BEGIN
 
@@ -40,7 +44,34 @@ public:
     TetrahedralMeshGenerator();
     ~TetrahedralMeshGenerator();
 
+    void setNeighborOutput(bool);
+    bool getNeighborOutput() const;
+
+    void setRegionAttributes(bool);
+    bool getRegionAttributes() const;
+
+    void setThreadCount(size_t);
+    size_t getThreadCount() const;
+
+    void setProgress(Progress *);
+    Progress * getProgress() const;
+
     void tetrahedralizeMesh(Geometry *, size_t, float) const;
+    void tetrahedralizeAll(Geometry *, float) const;
+
+private:
+    bool neighborOutput;
+    bool regionAttributes;
+
+    size_t threadCount;
+    Progress * progress;
+
+    bool isCancelled() const;
+
+    void createBehavior(tetgenbehavior &, float) const;
+    void createInput(const Geometry *, size_t, tetgenio *) const;
+    void releaseInput(tetgenio *) const;
+    void storeOutput(Geometry *, size_t, tetgenio *) const;
 };
 
 VIRGO_NAMESPACE_END
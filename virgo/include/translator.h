@@ -46,14 +46,21 @@ public:
     void setLanguage(const Language &);
 
     char * OPEN, *IMPORT, *INFORMATION, *VIEWPORT, *TETRAHEDRALIZE,
-        *DELETE, *EXPORT, *SAVE, *CLOSE, *PREFERENCES, *ABOUT, *EXIT,
+        *DECIMATE, *DELETE, *EXPORT, *SAVE, *CLOSE, *PREFERENCES, *ABOUT, *EXIT,
         *CURRENT_FILE, *NO_FILE, *OPEN_FILE, *IMPORT_FILE, *MESHES, *NONE,
-        *VERTEX_COUNT, *POLYGON_COUNT, *MESH_COUNT, *TETRAHEDRALIZE_MESH,
-        *EDGE_RATIO_PARAMETER, *DELETE_MESH, *EXPORT_MESH, *EXPORT_FILE,
+        *VERTEX_COUNT, *POLYGON_COUNT, *MESH_COUNT, *TETRAHEDRON_COUNT,
+        *TETRAHEDRALIZE_MESH, *DECIMATE_MESH, *ALL_MESHES,
+        *EDGE_RATIO_PARAMETER, *TARGET_TRIANGLE_COUNT, *MAXIMUM_ERROR,
+        *DELETE_MESH, *EXPORT_MESH, *EXPORT_FILE,
         *OVERWRITE_FILE, *SAVE_FILE, *DEFAULT_LANGUAGE, *ENGLISH, *PORTUGUESE,
-        *SPANISH, *DEFAULT_THEME, *LIGHT, *DARK, *ABOUT_VIRGO, *DEPENDENCIES,
-        *OPENING, *IMPORTING, *TETRAHEDRALIZING, *DELETING, *EXPORTING,
-        *SAVING, *YES, *NO, *OK, *CANCEL;
+        *SPANISH, *DEFAULT_THEME, *LIGHT, *DARK, *DEFAULT_ORDERING, *FILE_ORDERING,
+        *MORTON_ORDERING, *HILBERT_ORDERING, *ABOUT_VIRGO, *DEPENDENCIES,
+        *OPENING, *IMPORTING, *TETRAHEDRALIZING, *DECIMATING, *REORDERING, *DELETING,
+        *EXPORTING, *SAVING, *YES, *NO, *OK, *CANCEL, *MEMORY_USAGE, *PEAK_MEMORY_USAGE,
+        *READ_STATISTICS, *PROGRESS, *OPERATION_PROGRESS, *OPERATION_CANCELLED,
+        *INVALID_FILE, *OPERATION_FAILED, *OPERATION_RUNNING, *PREPARING, *STORING,
+        *CANCELLING, *CANCEL_OPERATION,
+        *SELF_INTERSECTION, *INTERSECTING_FACES, *MORE_INTERSECTIONS;
 
 private:
     void setEnglishLanguage();
@@ -0,0 +1,91 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VERTEX_CACHE_OPTIMIZER_H
+#define VERTEX_CACHE_OPTIMIZER_H
+
+#include "namespace.h"
+#include "data.h"
+#include <vector>
+
+VIRGO_NAMESPACE_BEGIN
+
+using namespace std;
+
+class VertexCacheOptimizer {
+public:
+    VertexCacheOptimizer();
+    ~VertexCacheOptimizer();
+
+    void setCacheSize(size_t);
+    size_t getCacheSize() const;
+
+    void setClusterOrdering(bool);
+    bool getClusterOrdering() const;
+
+    void setOverdrawThreshold(float);
+    float getOverdrawThreshold() const;
+
+    void setFetchOrdering(bool);
+    bool getFetchOrdering() const;
+
+    void optimize(unsigned int *, size_t, const Vector *, size_t, size_t);
+
+    const vector<unsigned int> & getRemap() const;
+
+    float getInitialCacheMissRatio() const;
+    float getCacheMissRatio() const;
+    size_t getClusterCount() const;
+
+    static float getCacheMissRatio(const unsigned int *, size_t, size_t, size_t);
+
+private:
+    vector<unsigned int> remap;
+
+    vector<unsigned int> offsets;
+    vector<unsigned int> adjacency;
+    vector<unsigned int> order;
+    vector<unsigned int> clusters;
+
+    size_t cacheSize;
+    bool clusterOrdering;
+    float overdrawThreshold;
+    bool fetchOrdering;
+
+    float initialCacheMissRatio;
+    float cacheMissRatio;
+
+    void buildAdjacency(const unsigned int *, size_t, size_t);
+    void orderTriangles(const unsigned int *, size_t, size_t);
+    void splitClusters(const unsigned int *, size_t);
+    void sortClusters(const unsigned int *, size_t, const Vector *, size_t);
+    void orderVertices(unsigned int *, size_t, size_t);
+};
+
+VIRGO_NAMESPACE_END
+
+#endif
\ No newline at end of file
@@ -30,11 +30,61 @@
 
 #include "namespace.h"
 #include "data.h"
+#include "renderer.h"
+#include <string>
+#include <vector>
 
 #define ESC 27
 
 VIRGO_NAMESPACE_BEGIN
 
+using namespace std;
+
+struct CameraKey {
+    CameraKey(const Vector & = Vector(0, 0, 0), const Vector & = Vector(0, 0, 0));
+    ~CameraKey();
+
+    Vector motion;
+    Vector rotation;
+};
+
+struct BenchmarkSettings {
+    BenchmarkSettings();
+    ~BenchmarkSettings();
+
+    int width;
+    int height;
+
+    size_t frameCount;
+    size_t warmupCount;
+
+    vector<CameraKey> cameraPath;
+    string imagePrefix;
+
+    bool loadCameraPath(const char *);
+};
+
+struct FrameStatistics {
+    FrameStatistics();
+    ~FrameStatistics();
+
+    size_t frameCount;
+    size_t triangleCount;
+
+    double totalTime;
+    double minimumTime;
+    double medianTime;
+    double percentile90Time;
+    double percentile99Time;
+    double maximumTime;
+
+    float initialCacheMissRatio;
+    float cacheMissRatio;
+
+    double getFrameRate() const;
+    double getTriangleRate() const;
+};
+
 class Viewport {
 public:
     Viewport();
@@ -43,10 +93,13 @@ public:
     void show();
     void loadGeometry(const Geometry *);
 
+    bool benchmark(const BenchmarkSettings &, FrameStatistics &);
+
 private:
-    int window, object;
+    int window;
 
     Geometry * geometry;
+    Renderer renderer;
 
     int windowWidth;
     int windowHeight;
@@ -65,13 +118,20 @@ private:
 
     Vector mouseMotion, mouseRotation;
 
-    void initialize();
+    void initialize(RendererLoader);
     void loadObject();
     void drawObject();
     void drawGrid(int);
     void setDefaultViewport();
+    void setProjection(int, int);
+    void render();
     void close();
 
+    CameraKey getCameraKey(const vector<CameraKey> &, size_t, size_t) const;
+    vector<CameraKey> createOrbitPath() const;
+    size_t getDrawnTriangleCount() const;
+    bool writeImage(const string &, int, int) const;
+
     void display();
     void reshape(int, int);
     void keyboardEvent(unsigned char, int, int);
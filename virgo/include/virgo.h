@@ -30,5 +30,7 @@
 
 #include "namespace.h"
 #include "application.h"
+#include "batch.h"
+#include "service.h"
 
 #endif
\ No newline at end of file
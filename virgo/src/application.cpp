@@ -26,21 +26,28 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "application.h"
+#include "resourceUsage.h"
 #include <iostream>
 #include <cstdlib>
 #include <algorithm>
 #include <sstream>
 #include <cstring>
 
+#define INTERSECTION_REPORT_SIZE 10
+
 VIRGO_NAMESPACE_BEGIN
 
-Preferences::Preferences(const Language & language,
-    const Theme & theme) : language(language), theme(theme) {}
+Preferences::Preferences(const Language & language, const Theme & theme,
+    const VertexOrdering & ordering) : language(language), theme(theme), ordering(ordering) {}
 
 Preferences::~Preferences() {}
 
 Application::Application() {
     geometry = nullptr;
+
+    taskState = ApplicationState::MainState;
+    taskGeometry = nullptr;
+    taskStatus = TaskStatus::CompletedStatus;
     
     preferenceFile = fopen("preferences", "rb+");
     
@@ -54,10 +61,14 @@ Application::Application() {
             fwrite(&preferences, sizeof(Preferences), 1, preferenceFile);
     }
 
-    fclose(preferenceFile);
+    if (preferenceFile != nullptr) {
+        fclose(preferenceFile);
+        preferenceFile = nullptr;
+    }
 
     translator.setLanguage(preferences.language);
     setTheme(preferences.theme);
+    reorderer.setOrdering(preferences.ordering);
 
     clear();
 }
@@ -65,98 +76,181 @@ Application::Application() {
 Application::~Application() {
     if (preferenceFile != nullptr)
         fclose(preferenceFile);
+
+    if (task.isActive()) {
+        task.cancel();
+
+        if (taskState == ApplicationState::TetrahedralizeState) {
+            task.detach();
+            taskGeometry = nullptr;
+        }
+        else {
+            task.wait();
+        }
+
+        if (taskGeometry != nullptr)
+            delete taskGeometry;
+
+        taskGeometry = nullptr;
+    }
     
     removeData();
 }
 
 void Application::show() {
+    ApplicationState state = ApplicationState::MainState;
+
+    while (state != ApplicationState::ExitState && cin) {
+        completeTask();
+
+        switch (state) {
+            case ApplicationState::OpenState:
+                state = openAction();
+                break;
+            case ApplicationState::ImportState:
+                state = importAction();
+                break;
+            case ApplicationState::InformationState:
+                state = informationAction();
+                break;
+            case ApplicationState::ViewportState:
+                state = viewportAction();
+                break;
+            case ApplicationState::TetrahedralizeState:
+                state = tetrahedralizeAction();
+                break;
+            case ApplicationState::DecimateState:
+                state = decimateAction();
+                break;
+            case ApplicationState::DeleteState:
+                state = deleteAction();
+                break;
+            case ApplicationState::ExportState:
+                state = exportAction();
+                break;
+            case ApplicationState::SaveState:
+                state = saveAction();
+                break;
+            case ApplicationState::CloseState:
+                state = closeAction();
+                break;
+            case ApplicationState::PreferencesState:
+                state = preferencesAction();
+                break;
+            case ApplicationState::AboutState:
+                state = aboutAction();
+                break;
+            case ApplicationState::ProgressState:
+                state = progressAction();
+                break;
+            default:
+                state = mainAction();
+        }
+    }
+}
+
+ApplicationState Application::mainAction() {
     clear();
 
     createTitle();
     separator();
 
+    bool busy = isBusy();
+    taskStatus = TaskStatus::CompletedStatus;
+
+    if (busy) {
+        print(translator.OPERATION_RUNNING);
+        separator();
+    }
+
     vector<string> menu;
     menu.push_back(translator.OPEN);
     menu.push_back(translator.IMPORT);
     menu.push_back(translator.INFORMATION);
     menu.push_back(translator.VIEWPORT);
     menu.push_back(translator.TETRAHEDRALIZE);
+    menu.push_back(translator.DECIMATE);
     menu.push_back(translator.DELETE);
     menu.push_back(translator.EXPORT);
     menu.push_back(translator.SAVE);
     menu.push_back(translator.CLOSE);
     menu.push_back(translator.PREFERENCES);
     menu.push_back(translator.ABOUT);
+    menu.push_back(translator.PROGRESS);
     menu.push_back(translator.EXIT);
 
     createMenu(menu);
     separator();
 
     requestOption();
+    completeTask();
+
+    busy = isBusy();
 
     switch (option) {
         case 1:
-            openAction();
-            break;
+            if (!busy)
+                return ApplicationState::OpenState;
+            else
+                return ApplicationState::MainState;
         case 2:
-            if (geometry != nullptr)
-                importAction();
+            if (geometry != nullptr && !busy)
+                return ApplicationState::ImportState;
             else
-                show();
-            break;
+                return ApplicationState::MainState;
         case 3:
             if (geometry != nullptr)
-                informationAction();
+                return ApplicationState::InformationState;
             else
-                show();
-            break;
+                return ApplicationState::MainState;
         case 4:
             if (geometry != nullptr)
-                viewportAction();
+                return ApplicationState::ViewportState;
             else
-                show();
-            break;
+                return ApplicationState::MainState;
         case 5:
-            if (hasMesh())
-                tetrahedralizeAction();
+            if (hasMesh() && !busy)
+                return ApplicationState::TetrahedralizeState;
             else
-                show();
-            break;
+                return ApplicationState::MainState;
         case 6:
-            if (hasMesh())
-                deleteAction();
+            if (hasMesh() && !busy)
+                return ApplicationState::DecimateState;
             else
-                show();
-            break;
+                return ApplicationState::MainState;
         case 7:
-            if (hasMesh())
-                exportAction();
+            if (hasMesh() && !busy)
+                return ApplicationState::DeleteState;
             else
-                show();
-            break;
+                return ApplicationState::MainState;
         case 8:
-            if (geometry != nullptr)
-                saveAction();
+            if (hasMesh() && !busy)
+                return ApplicationState::ExportState;
             else
-                show();
-            break;
+                return ApplicationState::MainState;
         case 9:
-            if (geometry != nullptr)
-                closeAction();
+            if (geometry != nullptr && !busy)
+                return ApplicationState::SaveState;
             else
-                show();
-            break;
+                return ApplicationState::MainState;
         case 10:
-            preferencesAction();
-            break;
+            if (geometry != nullptr && !busy)
+                return ApplicationState::CloseState;
+            else
+                return ApplicationState::MainState;
         case 11:
-            aboutAction();
-            break;
+            return ApplicationState::PreferencesState;
         case 12:
-            exitAction();
-            break;
+            return ApplicationState::AboutState;
+        case 13:
+            if (busy)
+                return ApplicationState::ProgressState;
+            else
+                return ApplicationState::MainState;
+        case 14:
+            return ApplicationState::ExitState;
         default:
-            show();
+            return ApplicationState::MainState;
     }
 }
 
@@ -182,6 +276,24 @@ void Application::createTitle() {
     else {
         print(translator.NO_FILE);
     }
+
+    const Progress * progress = task.getProgress();
+
+    if (progress != nullptr) {
+        const char * phase = progress->isCancelled() ? translator.CANCELLING
+            : getPhaseName(progress->getPhase());
+
+        printf(translator.OPERATION_PROGRESS, phase, progress->getFraction() * 100.0);
+    }
+    else if (taskStatus == TaskStatus::InvalidStatus) {
+        print(translator.INVALID_FILE);
+    }
+    else if (taskStatus == TaskStatus::FailedStatus) {
+        print(translator.OPERATION_FAILED);
+    }
+    else if (taskStatus == TaskStatus::CancelledStatus) {
+        print(translator.OPERATION_CANCELLED);
+    }
 }
 
 void Application::createMenu(const vector<string> & menuList) {
@@ -271,12 +383,6 @@ void Application::removeData() {
     geometry = nullptr;
 }
 
-void Application::defragmentGeometry() {
-    if (geometry != nullptr)
-        geometry->meshes.erase(remove(geometry->meshes.begin(), geometry->meshes.end(), nullptr),
-            geometry->meshes.end());
-}
-
 bool Application::hasMesh() const {
     if (geometry != nullptr) {
         if (geometry->getMeshCount() != 0)
@@ -286,7 +392,135 @@ bool Application::hasMesh() const {
     return false;
 }
 
-void Application::openAction() {
+void Application::startTask(const ApplicationState & state,
+    const function<TaskStatus(Progress *)> & job) {
+    taskState = state;
+    taskStatus = TaskStatus::CompletedStatus;
+
+    task.start(job);
+}
+
+void Application::completeTask() {
+    if (!task.isFinished())
+        return;
+
+    TaskStatus status = task.wait();
+
+    if (status == TaskStatus::CompletedStatus) {
+        switch (taskState) {
+            case ApplicationState::OpenState:
+                if (geometry != nullptr)
+                    delete geometry;
+
+                geometry = taskGeometry;
+                taskGeometry = nullptr;
+
+                filename = taskFilename;
+                statistics = file.getStatistics();
+
+                viewport.loadGeometry(geometry);
+                break;
+            case ApplicationState::ImportState:
+                geometry->merge(taskGeometry);
+                statistics = file.getStatistics();
+                break;
+            case ApplicationState::TetrahedralizeState:
+            case ApplicationState::DecimateState:
+                delete geometry;
+
+                geometry = taskGeometry;
+                taskGeometry = nullptr;
+
+                viewport.loadGeometry(geometry);
+                break;
+            case ApplicationState::SaveState:
+                remove(taskFilename.c_str());
+
+                if (rename(getTemporaryFilename(taskFilename).c_str(), taskFilename.c_str()) == 0)
+                    filename = taskFilename;
+
+                break;
+            default:
+                break;
+        }
+    }
+    else if (taskState == ApplicationState::SaveState) {
+        remove(getTemporaryFilename(taskFilename).c_str());
+    }
+
+    if (taskGeometry != nullptr)
+        delete taskGeometry;
+
+    taskGeometry = nullptr;
+    taskStatus = status;
+}
+
+bool Application::isBusy() const {
+    return task.isActive();
+}
+
+const char * Application::getPhaseName(const ProgressPhase & phase) const {
+    switch (phase) {
+        case ProgressPhase::ParsingPhase:
+            if (taskState == ApplicationState::ImportState)
+                return translator.IMPORTING;
+            else
+                return translator.OPENING;
+        case ProgressPhase::WritingPhase:
+            return translator.SAVING;
+        case ProgressPhase::MeshingPhase:
+            return translator.TETRAHEDRALIZING;
+        case ProgressPhase::DecimatingPhase:
+            return translator.DECIMATING;
+        case ProgressPhase::ReorderingPhase:
+            return translator.REORDERING;
+        case ProgressPhase::StoringPhase:
+            return translator.STORING;
+        default:
+            return translator.PREPARING;
+    }
+}
+
+string Application::getTemporaryFilename(const string & filename) const {
+    size_t position = filename.find_last_of("\\/");
+
+    if (position == string::npos)
+        return "~" + filename;
+
+    return filename.substr(0, position + 1) + "~" + filename.substr(position + 1);
+}
+
+bool Application::checkIntersections(size_t index, bool all) {
+    size_t first = all ? 0 : index;
+    size_t last = all ? geometry->getMeshCount() : index + 1;
+
+    for (size_t i = first; i < last; i++) {
+        if (checker.checkMesh(geometry, i))
+            continue;
+
+        const vector<Intersection> & intersections = checker.getIntersections();
+        size_t count = min<size_t>(intersections.size(), INTERSECTION_REPORT_SIZE);
+
+        separator();
+
+        printf(translator.SELF_INTERSECTION, geometry->getMeshByIndex(i)->name.c_str(),
+            intersections.size());
+
+        for (size_t j = 0; j < count; j++)
+            printf(translator.INTERSECTING_FACES, intersections[j].first + 1, intersections[j].second + 1);
+
+        if (intersections.size() > count)
+            printf(translator.MORE_INTERSECTIONS, intersections.size() - count);
+
+        separator();
+
+        return false;
+    }
+
+    return true;
+}
+
+ApplicationState Application::openAction() {
     clear();
 
     createTitle();
@@ -314,46 +548,69 @@ void Application::openAction() {
     requestOption();
 
     switch (option) {
-        case 1:
+        case 1: {
             file.open(newFilename.c_str(), FileMode::Read);
 
-            if (!file.isOpen())
+            if (!file.isOpen()) {
                 file.open(newFilename.c_str(), FileMode::Write);
 
-            if (file.isOpen()) {
-                separator();
-                print(translator.OPENING);
+                if (!file.isOpen())
+                    return ApplicationState::OpenState;
+
+                file.close();
 
                 if (geometry != nullptr)
                     delete geometry;
 
                 geometry = new Geometry;
+                filename = newFilename;
+                statistics = FileStatistics();
 
-                file.read(geometry);
+                viewport.loadGeometry(geometry);
+
+                return ApplicationState::MainState;
+            }
+
+            separator();
+            print(translator.OPENING);
+
+            Geometry * target = new Geometry;
+            SpatialReorderer worker = reorderer;
+
+            taskGeometry = target;
+            taskFilename = newFilename;
+
+            startTask(ApplicationState::OpenState,
+                [this, target, worker](Progress * progress) mutable {
+                file.setProgress(progress);
+                bool status = file.read(target);
                 file.close();
+                file.setProgress(nullptr);
 
-                viewport.loadGeometry(geometry);
+                if (!status)
+                    return TaskStatus::InvalidStatus;
 
-                filename = newFilename;
+                if (progress->isCancelled())
+                    return TaskStatus::CancelledStatus;
 
-                show();
-            }
-            else {
-                openAction();
-            }
-            break;
+                worker.setProgress(progress);
+                worker.reorderGeometry(target);
+
+                return TaskStatus::CompletedStatus;
+            });
+
+            return ApplicationState::MainState;
+        }
         case 2:
-            show();
-            break;
+            return ApplicationState::MainState;
         case 3:
-            exitAction();
-            break;
+            return ApplicationState::ExitState;
         default:
-            openAction();
+            return ApplicationState::OpenState;
     }
 }
 
-void Application::importAction() {
+ApplicationState Application::importAction() {
     clear();
 
     createTitle();
@@ -388,51 +645,45 @@ void Application::importAction() {
                 separator();
                 print(translator.IMPORTING);
 
-                Geometry * newGeometry = new Geometry;
-                size_t offset = geometry->getVertexCount();
+                Geometry * target = new Geometry;
+                SpatialReorderer worker = reorderer;
 
-                file.read(newGeometry);
-                file.close();
+                taskGeometry = target;
 
-                for (size_t i = 0; i < newGeometry->getVertexCount(); i++)
-                    geometry->points.push_back(newGeometry->points[i]);
+                startTask(ApplicationState::ImportState,
+                    [this, target, worker](Progress * progress) mutable {
+                    file.setProgress(progress);
+                    bool status = file.read(target);
+                    file.close();
+                    file.setProgress(nullptr);
 
-                Mesh * mesh = nullptr;
-                Triangle * triangle = nullptr;
+                    if (!status)
+                        return TaskStatus::InvalidStatus;
 
-                for (size_t i = 0; i < newGeometry->getMeshCount(); i++) {
-                    mesh = newGeometry->getMeshByIndex(i);
+                    if (progress->isCancelled())
+                        return TaskStatus::CancelledStatus;
 
-                    for (size_t j = 0; j < mesh->triangles.size(); j++) {
-                        triangle = mesh->triangles[j];
+                    worker.setProgress(progress);
+                    worker.reorderGeometry(target);
 
-                        triangle->v1 += offset;
-                        triangle->v2 += offset;
-                        triangle->v3 += offset;
-                    }
+                    return TaskStatus::CompletedStatus;
+                });
 
-                    geometry->meshes.push_back(mesh);
-                }
-
-                show();
+                return ApplicationState::MainState;
             }
             else {
-                importAction();
+                return ApplicationState::ImportState;
             }
-
-            break;
         case 2:
-            show();
-            break;
+            return ApplicationState::MainState;
         case 3:
-            exitAction();
-            break;
+            return ApplicationState::ExitState;
         default:
-            importAction();
+            return ApplicationState::ImportState;
     }
 }
 
-void Application::informationAction() {
+ApplicationState Application::informationAction() {
     clear();
 
     createTitle();
@@ -446,6 +697,14 @@ void Application::informationAction() {
     printf(translator.VERTEX_COUNT, geometry->getVertexCount());
     printf(translator.POLYGON_COUNT, geometry->getPolygonCount());
     printf(translator.MESH_COUNT, meshCount);
+    printf(translator.TETRAHEDRON_COUNT, geometry->getTetrahedronCount());
+    printf(translator.MEMORY_USAGE, geometry->getUsedMemory() / 1048576.0,
+        geometry->getReservedMemory() / 1048576.0);
+    printf(translator.PEAK_MEMORY_USAGE, getMemoryUsage() / 1048576.0,
+        getPeakMemoryUsage() / 1048576.0);
+
+    printf(translator.READ_STATISTICS, statistics.size / 1048576.0,
+        statistics.time, statistics.getThroughput());
     separator();
 
     print(translator.MESHES);
@@ -471,23 +730,21 @@ void Application::informationAction() {
 
     switch (option) {
         case 1:
-            show();
-            break;
+            return ApplicationState::MainState;
         case 2:
-            exitAction();
-            break;
+            return ApplicationState::ExitState;
         default:
-            informationAction();
+            return ApplicationState::InformationState;
     }
 }
 
-void Application::viewportAction() {
+ApplicationState Application::viewportAction() {
     viewport.show();
 
-    show();
+    return ApplicationState::MainState;
 }
 
-void Application::tetrahedralizeAction() {
+ApplicationState Application::tetrahedralizeAction() {
     clear();
 
     createTitle();
@@ -501,6 +758,7 @@ void Application::tetrahedralizeAction() {
 
     float radiusEdgeRatio = 0;
     size_t index = 0;
+    bool all = false;
 
     if (meshCount != 1) {
         print(translator.TETRAHEDRALIZE_MESH);
@@ -509,16 +767,19 @@ void Application::tetrahedralizeAction() {
         for (size_t i = 0; i < meshCount; i++)
             meshNameList.push_back(geometry->getMeshByIndex(i)->name);
 
+        meshNameList.push_back(translator.ALL_MESHES);
+
         createMenu(meshNameList);
         separator();
 
         requestOption();
         separator();
 
-        if (option < 1 || option > meshCount)
-            tetrahedralizeAction();
+        if (option < 1 || option > meshCount + 1)
+            return ApplicationState::TetrahedralizeState;
 
         index = option - 1;
+        all = index == meshCount;
     }
 
     bool status;
@@ -541,29 +802,159 @@ void Application::tetrahedralizeAction() {
     switch (option) {
         case 1:
             if (status && radiusEdgeRatio > 1.0) {
+                if (!checkIntersections(index, all)) {
+                    vector<string> reportMenu;
+                    reportMenu.push_back(translator.OK);
+                    reportMenu.push_back(translator.EXIT);
+
+                    createMenu(reportMenu);
+                    separator();
+
+                    requestOption();
+
+                    return option == 2 ? ApplicationState::ExitState : ApplicationState::MainState;
+                }
+
                 separator();
                 print(translator.TETRAHEDRALIZING);
 
-                generator.tetrahedralizeMesh(geometry, index, radiusEdgeRatio);
+                Geometry * target = new Geometry;
+                TetrahedralMeshGenerator worker = generator;
+
+                target->clone(geometry);
+                taskGeometry = target;
+
+                startTask(ApplicationState::TetrahedralizeState,
+                    [target, worker, index, all, radiusEdgeRatio](Progress * progress) mutable {
+                    worker.setProgress(progress);
 
-                show();
+                    if (all)
+                        worker.tetrahedralizeAll(target, radiusEdgeRatio);
+                    else
+                        worker.tetrahedralizeMesh(target, index, radiusEdgeRatio);
+
+                    return TaskStatus::CompletedStatus;
+                });
+
+                return ApplicationState::MainState;
             }
             else {
-                tetrahedralizeAction();
+                return ApplicationState::TetrahedralizeState;
             }
-            break;
         case 2:
-            show();
-            break;
+            return ApplicationState::MainState;
         case 3:
-            exitAction();
-            break;
+            return ApplicationState::ExitState;
+        default:
+            return ApplicationState::TetrahedralizeState;
+    }
+}
+
+ApplicationState Application::decimateAction() {
+    clear();
+
+    createTitle();
+    separator();
+
+    print(translator.DECIMATE);
+    separator();
+
+    size_t meshCount = geometry->getMeshCount();
+    vector<string> meshNameList;
+
+    float targetCount = 0;
+    float maximumError = 0;
+    size_t index = 0;
+    bool all = false;
+
+    if (meshCount != 1) {
+        print(translator.DECIMATE_MESH);
+        separator();
+
+        for (size_t i = 0; i < meshCount; i++)
+            meshNameList.push_back(geometry->getMeshByIndex(i)->name);
+
+        meshNameList.push_back(translator.ALL_MESHES);
+
+        createMenu(meshNameList);
+        separator();
+
+        requestOption();
+        separator();
+
+        if (option < 1 || option > meshCount + 1)
+            return ApplicationState::DecimateState;
+
+        index = option - 1;
+        all = index == meshCount;
+    }
+
+    bool targetStatus, errorStatus;
+    print(translator.TARGET_TRIANGLE_COUNT);
+    separator();
+
+    requestParameter(targetCount, targetStatus);
+    separator();
+
+    print(translator.MAXIMUM_ERROR);
+    separator();
+
+    requestParameter(maximumError, errorStatus);
+    separator();
+
+    vector<string> menu;
+    menu.push_back(translator.DECIMATE);
+    menu.push_back(translator.CANCEL);
+    menu.push_back(translator.EXIT);
+
+    createMenu(menu);
+    separator();
+
+    requestOption();
+
+    switch (option) {
+        case 1:
+            if (targetStatus && errorStatus && targetCount >= 0 && maximumError >= 0
+                && (targetCount >= 1 || maximumError > 0)) {
+                separator();
+                print(translator.DECIMATING);
+
+                Geometry * target = new Geometry;
+                Decimator worker = decimator;
+
+                worker.setTargetCount((size_t)targetCount);
+                worker.setMaximumError(maximumError);
+
+                target->clone(geometry);
+                taskGeometry = target;
+
+                startTask(ApplicationState::DecimateState,
+                    [target, worker, index, all](Progress * progress) mutable {
+                    worker.setProgress(progress);
+
+                    if (all)
+                        worker.decimateAll(target);
+                    else
+                        worker.decimateMesh(target, index);
+
+                    return TaskStatus::CompletedStatus;
+                });
+
+                return ApplicationState::MainState;
+            }
+            else {
+                return ApplicationState::DecimateState;
+            }
+        case 2:
+            return ApplicationState::MainState;
+        case 3:
+            return ApplicationState::ExitState;
         default:
-            tetrahedralizeAction();
+            return ApplicationState::DecimateState;
     }
 }
 
-void Application::deleteAction() {
+ApplicationState Application::deleteAction() {
     clear();
 
     createTitle();
@@ -591,7 +982,7 @@ void Application::deleteAction() {
         separator();
 
         if (option < 1 || option > meshCount)
-            deleteAction();
+            return ApplicationState::DeleteState;
 
         index = option - 1;
     }
@@ -611,34 +1002,19 @@ void Application::deleteAction() {
             separator();
             print(translator.DELETING);
 
-            if (meshCount == 1) {
-                for (size_t i = 0; i < geometry->getVertexCount(); i++) {
-                    if (geometry->points[i] != nullptr)
-                        delete geometry->points[i];
-                }
-
-                geometry->points.clear();
-            }
-        
-            delete geometry->getMeshByIndex(index);
-            geometry->meshes[index] = nullptr;
-        
-            defragmentGeometry();
-            show();
-
-            break;
+            geometry->removeMeshByIndex(index);
+            geometry->removeUnusedPoints();
+            return ApplicationState::MainState;
         case 2:
-            show();
-            break;
+            return ApplicationState::MainState;
         case 3:
-            exitAction();
-            break;
+            return ApplicationState::ExitState;
         default:
-            deleteAction();
+            return ApplicationState::DeleteState;
     }
 }
 
-void Application::exportAction() {
+ApplicationState Application::exportAction() {
     clear();
 
     createTitle();
@@ -667,7 +1043,7 @@ void Application::exportAction() {
         separator();
 
         if (option < 1 || option > meshCount)
-            exportAction();
+            return ApplicationState::ExportState;
 
         index = option - 1;
     }
@@ -698,41 +1074,28 @@ void Application::exportAction() {
 
                 Geometry * newGeometry = new Geometry;
 
-                vector<Vector *> points;
-                vector<Triangle *> triangles;
-
-                geometry->getMeshDataByIndex(index, points, triangles);
-
-                newGeometry->meshes.push_back(new Mesh);
-
-                newGeometry->meshes[0]->name = geometry->getMeshByIndex(index)->name;
-                newGeometry->meshes[0]->triangles = triangles;
-                newGeometry->points = points;
+                geometry->extractMesh(index, newGeometry);
 
                 file.write(newGeometry);
                 file.close();
 
                 delete newGeometry;
 
-                show();
+                return ApplicationState::MainState;
             }
             else {
-                exportAction();
+                return ApplicationState::ExportState;
             }
-
-            break;
         case 2:
-            show();
-            break;
+            return ApplicationState::MainState;
         case 3:
-            exitAction();
-            break;
+            return ApplicationState::ExitState;
         default:
-            exportAction();
+            return ApplicationState::ExportState;
     }
 }
 
-void Application::saveAction() {
+ApplicationState Application::saveAction() {
     clear();
 
     createTitle();
@@ -759,7 +1122,7 @@ void Application::saveAction() {
     separator();
 
     if (option < 1 || option > menu.size())
-        return saveAction();
+        return ApplicationState::SaveState;
 
     if (option == 1) {
         print(translator.SAVE_FILE);
@@ -784,45 +1147,43 @@ void Application::saveAction() {
 
     switch (option) {
         case 1:
-            if (overwrite)
-                file.open(filename.c_str(), FileMode::Write);
-            else
-                file.open(newFilename.c_str(), FileMode::Write);
+            taskFilename = overwrite ? filename : newFilename;
+
+            file.open(getTemporaryFilename(taskFilename).c_str(), FileMode::Write);
 
             if (file.isOpen()) {
                 separator();
                 print(translator.SAVING);
 
-                file.write(geometry);
-                file.close();
+                startTask(ApplicationState::SaveState, [this](Progress * progress) {
+                    file.setProgress(progress);
+                    bool status = file.write(geometry);
+                    file.close();
+                    file.setProgress(nullptr);
 
-                if (!overwrite)
-                    filename = newFilename;
+                    return status ? TaskStatus::CompletedStatus : TaskStatus::FailedStatus;
+                });
 
-                show();
+                return ApplicationState::MainState;
             }
             else {
-                saveAction();
+                return ApplicationState::SaveState;
             }
-
-            break;
         case 2:
-            show();
-            break;
+            return ApplicationState::MainState;
         case 3:
-            exitAction();
-            break;
+            return ApplicationState::ExitState;
         default:
-            saveAction();
+            return ApplicationState::SaveState;
     }
 }
 
-void Application::closeAction() {
+ApplicationState Application::closeAction() {
     removeData();
-    show();
+    return ApplicationState::MainState;
 }
 
-void Application::preferencesAction() {
+ApplicationState Application::preferencesAction() {
     clear();
 
     createTitle();
@@ -846,7 +1207,7 @@ void Application::preferencesAction() {
     separator();
 
     if (option < 1 || option > menu.size())
-        preferencesAction();
+        return ApplicationState::PreferencesState;
 
     preferences.language = (Language)(option - 1);
 
@@ -864,10 +1225,29 @@ void Application::preferencesAction() {
     separator();
 
     if (option < 1 || option > menu.size())
-        preferencesAction();
+        return ApplicationState::PreferencesState;
 
     preferences.theme = (Theme)(option - 1);
 
+    print(translator.DEFAULT_ORDERING);
+    separator();
+
+    menu.clear();
+    menu.push_back(translator.FILE_ORDERING);
+    menu.push_back(translator.MORTON_ORDERING);
+    menu.push_back(translator.HILBERT_ORDERING);
+
+    createMenu(menu);
+    separator();
+
+    requestOption();
+    separator();
+
+    if (option < 1 || option > menu.size())
+        return ApplicationState::PreferencesState;
+
+    preferences.ordering = (VertexOrdering)(option - 1);
+
     menu.clear();
     menu.push_back(translator.SAVE);
     menu.push_back(translator.CANCEL);
@@ -882,29 +1262,28 @@ void Application::preferencesAction() {
         case 1:
             preferenceFile = fopen("preferences", "wb+");
 
-            if (preferenceFile != nullptr)
+            if (preferenceFile != nullptr) {
                 fwrite(&preferences, sizeof(Preferences), 1, preferenceFile);
-        
-            fclose(preferenceFile);
+                fclose(preferenceFile);
+
+                preferenceFile = nullptr;
+            }
         
             translator.setLanguage(preferences.language);
             setTheme(preferences.theme);
+            reorderer.setOrdering(preferences.ordering);
 
-            show();
-
-            break;
+            return ApplicationState::MainState;
         case 2:
-            show();
-            break;
+            return ApplicationState::MainState;
         case 3:
-            exitAction();
-            break;
+            return ApplicationState::ExitState;
         default:
-            preferencesAction();
+            return ApplicationState::PreferencesState;
     }
 }
 
-void Application::aboutAction() {
+ApplicationState Application::aboutAction() {
     clear();
 
     createTitle();
@@ -948,18 +1327,51 @@ void Application::aboutAction() {
 
     switch (option) {
         case 1:
-            show();
-            break;
+            return ApplicationState::MainState;
         case 2:
-            exitAction();
-            break;
+            return ApplicationState::ExitState;
         default:
-            aboutAction();
+            return ApplicationState::AboutState;
     }
 }
 
-void Application::exitAction() {
-    exit(0);
+ApplicationState Application::progressAction() {
+    clear();
+
+    createTitle();
+    separator();
+
+    print(translator.PROGRESS);
+    separator();
+
+    const Progress * progress = task.getProgress();
+
+    if (progress != nullptr) {
+        printf("%zu / %zu\n", progress->getCompleted(), progress->getTotal());
+        separator();
+    }
+
+    vector<string> menu;
+    menu.push_back(translator.OK);
+    menu.push_back(translator.CANCEL_OPERATION);
+    menu.push_back(translator.EXIT);
+
+    createMenu(menu);
+    separator();
+
+    requestOption();
+
+    switch (option) {
+        case 1:
+            return ApplicationState::MainState;
+        case 2:
+            task.cancel();
+            return ApplicationState::MainState;
+        case 3:
+            return ApplicationState::ExitState;
+        default:
+            return ApplicationState::ProgressState;
+    }
 }
 
 VIRGO_NAMESPACE_END
\ No newline at end of file
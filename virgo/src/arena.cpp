@@ -0,0 +1,179 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "arena.h"
+#include <cstdlib>
+
+VIRGO_NAMESPACE_BEGIN
+
+Arena::Arena(size_t blockSize) : blockSize(blockSize) {
+    current = (size_t)-1;
+
+    reservedSize = 0;
+    usedSize = 0;
+}
+
+Arena::~Arena() {
+    release();
+}
+
+void * Arena::allocate(size_t size, size_t alignment) {
+    if (size == 0)
+        size = 1;
+
+    if (size + alignment > blockSize / 4) {
+        size_t index = createBlock(size, true);
+
+        blocks[index].offset = size;
+        usedSize += size;
+
+        return blocks[index].data;
+    }
+
+    if (current != (size_t)-1) {
+        Block & block = blocks[current];
+        size_t offset = (block.offset + alignment - 1) & ~(alignment - 1);
+
+        if (offset + size <= block.size) {
+            usedSize += offset + size - block.offset;
+            block.offset = offset + size;
+
+            return block.data + offset;
+        }
+    }
+
+    for (size_t i = current + 1; i < blocks.size(); i++) {
+        if (!blocks[i].dedicated && blocks[i].offset == 0 && blocks[i].size >= size) {
+            current = i;
+
+            blocks[i].offset = size;
+            usedSize += size;
+
+            return blocks[i].data;
+        }
+    }
+
+    current = createBlock(blockSize, false);
+
+    Block & block = blocks[current];
+    block.offset = size;
+    usedSize += size;
+
+    return block.data;
+}
+
+void Arena::deallocate(void * pointer, size_t size) {
+    if (pointer == nullptr)
+        return;
+
+    for (size_t i = blocks.size(); i > 0; i--) {
+        Block & block = blocks[i - 1];
+
+        if (block.dedicated && block.data == pointer) {
+            usedSize -= block.offset;
+            reservedSize -= block.size;
+
+            free(block.data);
+            blocks.erase(blocks.begin() + (i - 1));
+
+            if (current != (size_t)-1 && current > i - 1)
+                current--;
+
+            return;
+        }
+    }
+
+    if (current != (size_t)-1) {
+        Block & block = blocks[current];
+
+        if ((char *)pointer + size == block.data + block.offset) {
+            block.offset -= size;
+            usedSize -= size;
+        }
+    }
+}
+
+void Arena::reset() {
+    for (size_t i = blocks.size(); i > 0; i--) {
+        Block & block = blocks[i - 1];
+
+        if (block.dedicated) {
+            reservedSize -= block.size;
+
+            free(block.data);
+            blocks.erase(blocks.begin() + (i - 1));
+        }
+        else {
+            block.offset = 0;
+        }
+    }
+
+    current = blocks.empty() ? (size_t)-1 : 0;
+    usedSize = 0;
+}
+
+void Arena::release() {
+    for (size_t i = 0; i < blocks.size(); i++)
+        free(blocks[i].data);
+
+    blocks.clear();
+    current = (size_t)-1;
+
+    reservedSize = 0;
+    usedSize = 0;
+}
+
+size_t Arena::getReservedSize() const {
+    return reservedSize;
+}
+
+size_t Arena::getUsedSize() const {
+    return usedSize;
+}
+
+size_t Arena::getBlockCount() const {
+    return blocks.size();
+}
+
+size_t Arena::createBlock(size_t size, bool dedicated) {
+    Block block;
+
+    block.data = (char *)malloc(size);
+    block.size = size;
+    block.offset = 0;
+    block.dedicated = dedicated;
+
+    if (block.data == nullptr)
+        throw bad_alloc();
+
+    blocks.push_back(block);
+    reservedSize += size;
+
+    return blocks.size() - 1;
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,591 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "batch.h"
+#include "timer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+VIRGO_NAMESPACE_BEGIN
+
+static size_t findSeparator(const string & argument) {
+    for (size_t i = 0; i < argument.size(); i++) {
+        if (argument[i] == '\\')
+            i++;
+        else if (argument[i] == ':')
+            return i;
+    }
+
+    return string::npos;
+}
+
+static string unescapeName(const string & name) {
+    string result;
+
+    for (size_t i = 0; i < name.size(); i++) {
+        if (name[i] == '\\' && i + 1 < name.size())
+            i++;
+
+        result += name[i];
+    }
+
+    return result;
+}
+
+BatchStep::BatchStep(const BatchCommand & command, const string & argument)
+    : command(command), argument(argument), time(0), status(false) {}
+
+BatchStep::~BatchStep() {}
+
+Batch::Batch() {
+    geometry = nullptr;
+    scratch = nullptr;
+
+    verbose = true;
+    totalTime = 0;
+
+    checker.setMaximumCount(1);
+}
+
+Batch::~Batch() {
+    if (geometry != nullptr)
+        delete geometry;
+
+    if (scratch != nullptr)
+        delete scratch;
+}
+
+bool Batch::parse(int argc, char ** argv) {
+    return parse(vector<string>(argv + 1, argv + argc));
+}
+
+bool Batch::parse(const vector<string> & arguments) {
+    static const BatchCommand commands[] = {
+        BatchCommand::Open, BatchCommand::Import, BatchCommand::Tetrahedralize,
+        BatchCommand::Delete, BatchCommand::Export, BatchCommand::Save, BatchCommand::Weld,
+        BatchCommand::Decimate, BatchCommand::Reorder
+    };
+
+    reset();
+
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const char * option = arguments[i].c_str();
+        bool hasValue = i + 1 < arguments.size();
+
+        if (strncmp(option, "--", 2) != 0 || !hasValue) {
+            reportError("Invalid argument: %s", option);
+            steps.clear();
+
+            return false;
+        }
+
+        const char * value = arguments[++i].c_str();
+
+        if (strcmp(option, "--threads") == 0) {
+            setThreadCount(strtoul(value, nullptr, 10));
+            continue;
+        }
+
+        if (strcmp(option, "--precision") == 0) {
+            file.setPrecision(atoi(value));
+            continue;
+        }
+
+        bool status = false;
+
+        for (size_t j = 0; j < sizeof(commands) / sizeof(commands[0]); j++) {
+            if (strcmp(option + 2, getCommandName(commands[j])) == 0) {
+                steps.push_back(BatchStep(commands[j], value));
+                status = true;
+                break;
+            }
+        }
+
+        if (!status) {
+            reportError("Unknown option: %s", option);
+            steps.clear();
+
+            return false;
+        }
+    }
+
+    if (steps.empty() || steps.front().command != BatchCommand::Open) {
+        reportError("The first step must be %s.", "--open");
+        steps.clear();
+
+        return false;
+    }
+
+    return true;
+}
+
+int Batch::run() {
+    Timer timer, stepTimer;
+    bool status = true;
+
+    for (size_t i = 0; i < steps.size(); i++) {
+        BatchStep & step = steps[i];
+
+        step.time = 0;
+        step.status = false;
+    }
+
+    error.clear();
+
+    for (size_t i = 0; i < steps.size() && status; i++) {
+        BatchStep & step = steps[i];
+
+        stepTimer.reset();
+
+        switch (step.command) {
+            case BatchCommand::Open:
+                status = openStep(step.argument);
+                break;
+            case BatchCommand::Import:
+                status = importStep(step.argument);
+                break;
+            case BatchCommand::Tetrahedralize:
+                status = tetrahedralizeStep(step.argument);
+                break;
+            case BatchCommand::Delete:
+                status = deleteStep(step.argument);
+                break;
+            case BatchCommand::Export:
+                status = exportStep(step.argument);
+                break;
+            case BatchCommand::Save:
+                status = saveStep(step.argument);
+                break;
+            case BatchCommand::Weld:
+                status = weldStep(step.argument);
+                break;
+            case BatchCommand::Decimate:
+                status = decimateStep(step.argument);
+                break;
+            case BatchCommand::Reorder:
+                status = reorderStep(step.argument);
+                break;
+        }
+
+        step.time = stepTimer.getElapsedTime();
+        step.status = status;
+
+        if (verbose) {
+            printf("[%zu/%zu] %s %s: %.3f s%s\n", i + 1, steps.size(), getCommandName(step.command),
+                step.argument.c_str(), step.time, status ? "" : " (failed)");
+
+            fflush(stdout);
+        }
+    }
+
+    totalTime = timer.getElapsedTime();
+
+    if (verbose)
+        printf("Total: %.3f s\n", totalTime);
+
+    return status ? 0 : 2;
+}
+
+void Batch::reset() {
+    steps.clear();
+    error.clear();
+
+    totalTime = 0;
+}
+
+void Batch::setVerbose(bool verbose) {
+    this->verbose = verbose;
+}
+
+bool Batch::getVerbose() const {
+    return verbose;
+}
+
+void Batch::setThreadCount(size_t threadCount) {
+    file.setThreadCount(threadCount);
+    generator.setThreadCount(threadCount);
+    checker.setThreadCount(threadCount);
+    welder.setThreadCount(threadCount);
+    decimator.setThreadCount(threadCount);
+    reorderer.setThreadCount(threadCount);
+}
+
+void Batch::setDirectory(const string & directory) {
+    this->directory = directory;
+}
+
+const string & Batch::getDirectory() const {
+    return directory;
+}
+
+const vector<BatchStep> & Batch::getSteps() const {
+    return steps;
+}
+
+double Batch::getTotalTime() const {
+    return totalTime;
+}
+
+const string & Batch::getError() const {
+    return error;
+}
+
+size_t Batch::estimateMemory() const {
+    size_t size = 0;
+    struct stat status;
+
+    for (size_t i = 0; i < steps.size(); i++) {
+        const BatchStep & step = steps[i];
+
+        if ((step.command == BatchCommand::Open || step.command == BatchCommand::Import)
+            && stat(getPath(step.argument).c_str(), &status) == 0)
+            size += (size_t)status.st_size;
+    }
+
+    return size * 4;
+}
+
+bool Batch::isBatch(int argc, char ** argv) {
+    return argc > 1 && strncmp(argv[1], "--", 2) == 0;
+}
+
+void Batch::printUsage() {
+    fprintf(stderr, "Usage: virgo --open <file> [--import <file>] [--weld <mesh|all>[:tolerance]]\n"
+        "             [--decimate <mesh|all>:<triangles>[,error]] [--reorder <morton|hilbert>]\n"
+        "             [--tetrahedralize <mesh|all>[:ratio]] [--delete <mesh>]\n"
+        "             [--export <mesh>:<file>] [--save <file>]\n"
+        "             [--threads N] [--precision N]\n"
+        "Escape ':' and '\\' in mesh names with '\\'.\n");
+}
+
+bool Batch::openStep(const string & filename) {
+    if (geometry == nullptr)
+        geometry = new Geometry;
+    else
+        geometry->clear();
+
+    return readGeometry(filename, geometry);
+}
+
+bool Batch::importStep(const string & filename) {
+    if (scratch == nullptr)
+        scratch = new Geometry;
+
+    bool status = readGeometry(filename, scratch);
+
+    if (status)
+        geometry->merge(scratch);
+
+    scratch->clear();
+
+    return status;
+}
+
+bool Batch::tetrahedralizeStep(const string & argument) {
+    size_t separator = findSeparator(argument);
+    string target = unescapeName(argument.substr(0, separator));
+
+    float radiusEdgeRatio = 2.0;
+
+    if (separator != string::npos) {
+        char * end = nullptr;
+        radiusEdgeRatio = strtof(argument.c_str() + separator + 1, &end);
+
+        if (*end != '\0' || radiusEdgeRatio <= 1.0) {
+            reportError("Invalid radius-edge ratio: %s", argument.c_str() + separator + 1);
+            return false;
+        }
+    }
+
+    size_t index = 0;
+
+    if (target != "all" && !findMesh(target, index))
+        return false;
+
+    size_t first = target == "all" ? 0 : index;
+    size_t last = target == "all" ? geometry->getMeshCount() : index + 1;
+
+    for (size_t i = first; i < last; i++) {
+        if (!checker.checkMesh(geometry, i)) {
+            reportError("Mesh intersects itself: %s", geometry->getMeshByIndex(i)->name.c_str());
+            return false;
+        }
+    }
+
+    try {
+        if (target == "all")
+            generator.tetrahedralizeAll(geometry, radiusEdgeRatio);
+        else
+            generator.tetrahedralizeMesh(geometry, index, radiusEdgeRatio);
+    }
+    catch (...) {
+        reportError("Unable to tetrahedralize: %s", target.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool Batch::deleteStep(const string & name) {
+    size_t index = 0;
+
+    if (!findMesh(unescapeName(name), index))
+        return false;
+
+    geometry->removeMeshByIndex(index);
+    geometry->removeUnusedPoints();
+
+    return true;
+}
+
+bool Batch::exportStep(const string & argument) {
+    size_t separator = findSeparator(argument);
+
+    if (separator == string::npos) {
+        reportError("Invalid export target: %s", argument.c_str());
+        return false;
+    }
+
+    size_t index = 0;
+
+    if (!findMesh(unescapeName(argument.substr(0, separator)), index))
+        return false;
+
+    if (scratch == nullptr)
+        scratch = new Geometry;
+
+    geometry->extractMesh(index, scratch);
+
+    bool status = writeGeometry(argument.substr(separator + 1), scratch);
+
+    scratch->clear();
+
+    return status;
+}
+
+bool Batch::saveStep(const string & filename) {
+    return writeGeometry(filename, geometry);
+}
+
+bool Batch::weldStep(const string & argument) {
+    size_t separator = findSeparator(argument);
+    string target = unescapeName(argument.substr(0, separator));
+
+    float tolerance = 0;
+
+    if (separator != string::npos) {
+        char * end = nullptr;
+        tolerance = strtof(argument.c_str() + separator + 1, &end);
+
+        if (*end != '\0' || tolerance < 0) {
+            reportError("Invalid tolerance: %s", argument.c_str() + separator + 1);
+            return false;
+        }
+    }
+
+    size_t index = 0;
+
+    if (target != "all" && !findMesh(target, index))
+        return false;
+
+    welder.setTolerance(tolerance);
+
+    if (target == "all")
+        welder.weldGeometry(geometry);
+    else
+        welder.weldMesh(geometry, index);
+
+    return true;
+}
+
+bool Batch::decimateStep(const string & argument) {
+    size_t separator = findSeparator(argument);
+
+    if (separator == string::npos) {
+        reportError("Invalid decimation target: %s", argument.c_str());
+        return false;
+    }
+
+    string target = unescapeName(argument.substr(0, separator));
+    const char * parameters = argument.c_str() + separator + 1;
+
+    char * end = nullptr;
+    unsigned long long targetCount = strtoull(parameters, &end, 10);
+    float maximumError = 0;
+
+    if (end == parameters || *parameters == '-' || (*end != '\0' && *end != ',')) {
+        reportError("Invalid triangle count: %s", parameters);
+        return false;
+    }
+
+    if (*end == ',') {
+        const char * errorString = end + 1;
+        maximumError = strtof(errorString, &end);
+
+        if (end == errorString || *end != '\0' || maximumError < 0) {
+            reportError("Invalid maximum error: %s", errorString);
+            return false;
+        }
+    }
+
+    if (targetCount == 0 && maximumError == 0) {
+        reportError("Invalid decimation target: %s", argument.c_str());
+        return false;
+    }
+
+    size_t index = 0;
+
+    if (target != "all" && !findMesh(target, index))
+        return false;
+
+    decimator.setTargetCount((size_t)targetCount);
+    decimator.setMaximumError(maximumError);
+
+    if (target == "all")
+        decimator.decimateAll(geometry);
+    else
+        decimator.decimateMesh(geometry, index);
+
+    return true;
+}
+
+bool Batch::reorderStep(const string & ordering) {
+    if (ordering == "morton")
+        reorderer.setOrdering(VertexOrdering::MortonOrdering);
+    else if (ordering == "hilbert")
+        reorderer.setOrdering(VertexOrdering::HilbertOrdering);
+    else {
+        reportError("Invalid vertex ordering: %s", ordering.c_str());
+        return false;
+    }
+
+    reorderer.reorderGeometry(geometry);
+
+    return true;
+}
+
+bool Batch::readGeometry(const string & filename, Geometry * geometry) {
+    file.open(getPath(filename).c_str(), FileMode::Read);
+
+    if (!file.isOpen()) {
+        reportError("Unable to open file: %s", filename.c_str());
+        return false;
+    }
+
+    bool status = file.read(geometry);
+    file.close();
+
+    if (!status) {
+        reportError("Invalid or unsupported file: %s", filename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool Batch::writeGeometry(const string & filename, const Geometry * geometry) {
+    file.open(getPath(filename).c_str(), FileMode::Write);
+
+    if (!file.isOpen()) {
+        reportError("Unable to write file: %s", filename.c_str());
+        return false;
+    }
+
+    bool status = file.write(geometry);
+    file.close();
+
+    if (!status) {
+        reportError("Unable to write file: %s", filename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool Batch::findMesh(const string & name, size_t & index) {
+    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
+        if (geometry->getMeshByIndex(i)->name == name) {
+            index = i;
+            return true;
+        }
+    }
+
+    reportError("Mesh not found: %s", name.c_str());
+
+    return false;
+}
+
+string Batch::getPath(const string & filename) const {
+    if (directory.empty() || filename.empty() || filename[0] == '/' || filename[0] == '\\'
+        || (filename.size() > 1 && filename[1] == ':'))
+        return filename;
+
+#ifdef _WIN32
+    return directory + "\\" + filename;
+#else
+    return directory + "/" + filename;
+#endif
+}
+
+void Batch::reportError(const char * format, const char * value) {
+    char message[1024];
+    snprintf(message, sizeof(message), format, value);
+
+    error = message;
+
+    if (verbose)
+        fprintf(stderr, "%s\n", message);
+}
+
+const char * Batch::getCommandName(const BatchCommand & command) {
+    switch (command) {
+        case BatchCommand::Open:
+            return "open";
+        case BatchCommand::Import:
+            return "import";
+        case BatchCommand::Tetrahedralize:
+            return "tetrahedralize";
+        case BatchCommand::Delete:
+            return "delete";
+        case BatchCommand::Export:
+            return "export";
+        case BatchCommand::Save:
+            return "save";
+        case BatchCommand::Weld:
+            return "weld";
+        case BatchCommand::Decimate:
+            return "decimate";
+        case BatchCommand::Reorder:
+            return "reorder";
+    }
+
+    return "";
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
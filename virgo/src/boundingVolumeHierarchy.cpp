@@ -0,0 +1,806 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "boundingVolumeHierarchy.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+#define BIN_COUNT 16
+#define MAXIMUM_DEPTH 128
+#define PARALLEL_THRESHOLD 65536
+#define TRAVERSAL_COST 1.0f
+
+VIRGO_NAMESPACE_BEGIN
+
+struct BuildItem {
+    BoundingBox bounds;
+    Vector centroid;
+    Primitive primitive;
+};
+
+struct BuildBin {
+    BuildBin() : count(0) {}
+
+    BoundingBox bounds;
+    size_t count;
+};
+
+struct BuildTask {
+    size_t node;
+    size_t begin;
+    size_t end;
+    size_t depth;
+};
+
+struct BuildState {
+    vector<BuildItem> items;
+    vector<BoundingVolumeNode> * nodes;
+
+    atomic<size_t> nodeCount;
+    atomic<size_t> depth;
+
+    size_t leafSize;
+};
+
+static float getArea(const BoundingBox & box) {
+    if (box.isEmpty())
+        return 0;
+
+    Vector size = box.size();
+
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+static void setNode(BoundingVolumeNode & node, const BoundingBox & bounds, size_t offset, size_t count) {
+    node.minimum = bounds.min;
+    node.maximum = bounds.max;
+    node.offset = (uint32_t)offset;
+    node.count = (uint32_t)count;
+}
+
+static void extendBounds(BoundingBox & bounds, const Vector & minimum, const Vector & maximum) {
+    bounds.min.x = min(bounds.min.x, minimum.x);
+    bounds.min.y = min(bounds.min.y, minimum.y);
+    bounds.min.z = min(bounds.min.z, minimum.z);
+
+    bounds.max.x = max(bounds.max.x, maximum.x);
+    bounds.max.y = max(bounds.max.y, maximum.y);
+    bounds.max.z = max(bounds.max.z, maximum.z);
+}
+
+static size_t getBinIndex(const Vector & centroid, float minimum, float scale, int axis) {
+    size_t index = (size_t)((centroid[axis] - minimum) * scale);
+
+    return index < BIN_COUNT ? index : BIN_COUNT - 1;
+}
+
+static void addBounds(const BuildItem * items, size_t begin, size_t end,
+    BoundingBox & bounds, BoundingBox & centroids) {
+    for (size_t i = begin; i < end; i++) {
+        extendBounds(bounds, items[i].bounds.min, items[i].bounds.max);
+        extendBounds(centroids, items[i].centroid, items[i].centroid);
+    }
+}
+
+static void addBins(const BuildItem * items, size_t begin, size_t end, float minimum, float scale,
+    int axis, BuildBin (&bins)[BIN_COUNT]) {
+    for (size_t i = begin; i < end; i++) {
+        BuildBin & bin = bins[getBinIndex(items[i].centroid, minimum, scale, axis)];
+
+        extendBounds(bin.bounds, items[i].bounds.min, items[i].bounds.max);
+        bin.count++;
+    }
+}
+
+static void computeBounds(const BuildItem * items, size_t begin, size_t end,
+    BoundingBox & bounds, BoundingBox & centroids, size_t threadCount) {
+    bounds.makeEmpty();
+    centroids.makeEmpty();
+
+    if (threadCount == 1 || end - begin < PARALLEL_THRESHOLD) {
+        addBounds(items, begin, end, bounds, centroids);
+        return;
+    }
+
+    mutex lock;
+
+    parallelFor(end - begin, [&](size_t first, size_t last) {
+        BoundingBox localBounds, localCentroids;
+        addBounds(items, begin + first, begin + last, localBounds, localCentroids);
+
+        lock_guard<mutex> guard(lock);
+
+        bounds.extendBy(localBounds);
+        centroids.extendBy(localCentroids);
+    }, threadCount);
+}
+
+static void fillBins(const BuildItem * items, size_t begin, size_t end, float minimum, float scale,
+    int axis, BuildBin (&bins)[BIN_COUNT], size_t threadCount) {
+    if (threadCount == 1 || end - begin < PARALLEL_THRESHOLD) {
+        addBins(items, begin, end, minimum, scale, axis, bins);
+        return;
+    }
+
+    mutex lock;
+
+    parallelFor(end - begin, [&](size_t first, size_t last) {
+        BuildBin localBins[BIN_COUNT];
+        addBins(items, begin + first, begin + last, minimum, scale, axis, localBins);
+
+        lock_guard<mutex> guard(lock);
+
+        for (size_t i = 0; i < BIN_COUNT; i++) {
+            bins[i].bounds.extendBy(localBins[i].bounds);
+            bins[i].count += localBins[i].count;
+        }
+    }, threadCount);
+}
+
+static bool splitItems(BuildState & state, const BuildTask & task, const BoundingBox & bounds,
+    const BoundingBox & centroids, size_t threadCount, size_t & middle) {
+    size_t count = task.end - task.begin;
+
+    if (count <= 1 || task.depth + 1 >= MAXIMUM_DEPTH)
+        return false;
+
+    Vector extent = centroids.size();
+    int axis = extent.x >= extent.y ? (extent.x >= extent.z ? 0 : 2) : (extent.y >= extent.z ? 1 : 2);
+
+    if (extent[axis] <= 0) {
+        if (count <= state.leafSize)
+            return false;
+
+        middle = task.begin + count / 2;
+        return true;
+    }
+
+    BuildItem * items = state.items.data();
+    BuildBin bins[BIN_COUNT];
+
+    float minimum = centroids.min[axis];
+    float scale = BIN_COUNT / extent[axis];
+
+    fillBins(items, task.begin, task.end, minimum, scale, axis, bins, threadCount);
+
+    float rightAreas[BIN_COUNT];
+    size_t rightCounts[BIN_COUNT];
+
+    BoundingBox box;
+    size_t binCount = 0;
+
+    for (size_t i = BIN_COUNT - 1; i > 0; i--) {
+        box.extendBy(bins[i].bounds);
+        binCount += bins[i].count;
+
+        rightAreas[i] = getArea(box);
+        rightCounts[i] = binCount;
+    }
+
+    float bestCost = FLT_MAX;
+    size_t bestBin = 0;
+
+    box.makeEmpty();
+    binCount = 0;
+
+    for (size_t i = 0; i < BIN_COUNT - 1; i++) {
+        box.extendBy(bins[i].bounds);
+        binCount += bins[i].count;
+
+        if (binCount == 0 || rightCounts[i + 1] == 0)
+            continue;
+
+        float cost = binCount * getArea(box) + rightCounts[i + 1] * rightAreas[i + 1];
+
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestBin = i;
+        }
+    }
+
+    float area = getArea(bounds);
+    float splitCost = TRAVERSAL_COST + (area > 0 ? bestCost / area : 0);
+
+    if (count <= state.leafSize && splitCost >= (float)count)
+        return false;
+
+    middle = partition(items + task.begin, items + task.end, [&](const BuildItem & item) {
+        return getBinIndex(item.centroid, minimum, scale, axis) <= bestBin;
+    }) - items;
+
+    if (middle == task.begin || middle == task.end)
+        middle = task.begin + count / 2;
+
+    return true;
+}
+
+static void buildNode(BuildState & state, const BuildTask & task, size_t threadCount,
+    vector<BuildTask> & stack) {
+    BoundingBox bounds, centroids;
+    computeBounds(state.items.data(), task.begin, task.end, bounds, centroids, threadCount);
+
+    size_t depth = state.depth;
+
+    while (task.depth + 1 > depth && !state.depth.compare_exchange_weak(depth, task.depth + 1));
+
+    BoundingVolumeNode & node = (*state.nodes)[task.node];
+    size_t middle = 0;
+
+    if (!splitItems(state, task, bounds, centroids, threadCount, middle)) {
+        setNode(node, bounds, task.begin, task.end - task.begin);
+        return;
+    }
+
+    size_t child = state.nodeCount.fetch_add(2);
+
+    setNode(node, bounds, child, 0);
+
+    BuildTask right = { child + 1, middle, task.end, task.depth + 1 };
+    BuildTask left = { child, task.begin, middle, task.depth + 1 };
+
+    stack.push_back(right);
+    stack.push_back(left);
+}
+
+static bool intersectBox(const BoundingVolumeNode & node, const Vector & origin, const Vector & inverse,
+    float distance, float & entry) {
+    float minimum = 0, maximum = distance;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float first = (node.minimum[axis] - origin[axis]) * inverse[axis];
+        float second = (node.maximum[axis] - origin[axis]) * inverse[axis];
+
+        if (first > second)
+            swap(first, second);
+
+        minimum = first > minimum ? first : minimum;
+        maximum = second < maximum ? second : maximum;
+    }
+
+    entry = minimum;
+
+    return minimum <= maximum;
+}
+
+static bool intersectTriangle(const Ray & ray, const Vector & a, const Vector & b, const Vector & c,
+    float & distance, float & u, float & v) {
+    Vector firstEdge = b - a;
+    Vector secondEdge = c - a;
+
+    Vector p = ray.direction.cross(secondEdge);
+    float determinant = firstEdge.dot(p);
+
+    if (determinant == 0)
+        return false;
+
+    float inverse = 1.0f / determinant;
+    Vector t = ray.origin - a;
+
+    float s = t.dot(p) * inverse;
+
+    if (s < 0 || s > 1)
+        return false;
+
+    Vector q = t.cross(firstEdge);
+    float r = ray.direction.dot(q) * inverse;
+
+    if (r < 0 || s + r > 1)
+        return false;
+
+    float hitDistance = secondEdge.dot(q) * inverse;
+
+    if (hitDistance <= 0 || hitDistance >= distance)
+        return false;
+
+    distance = hitDistance;
+    u = s;
+    v = r;
+
+    return true;
+}
+
+static Vector getClosestPoint(const Vector & point, const Vector & a, const Vector & b, const Vector & c) {
+    Vector ab = b - a;
+    Vector ac = c - a;
+    Vector ap = point - a;
+
+    float d1 = ab.dot(ap);
+    float d2 = ac.dot(ap);
+
+    if (d1 <= 0 && d2 <= 0)
+        return a;
+
+    Vector bp = point - b;
+
+    float d3 = ab.dot(bp);
+    float d4 = ac.dot(bp);
+
+    if (d3 >= 0 && d4 <= d3)
+        return b;
+
+    float vc = d1 * d4 - d3 * d2;
+
+    if (vc <= 0 && d1 >= 0 && d3 <= 0)
+        return a + ab * (d1 / (d1 - d3));
+
+    Vector cp = point - c;
+
+    float d5 = ab.dot(cp);
+    float d6 = ac.dot(cp);
+
+    if (d6 >= 0 && d5 <= d6)
+        return c;
+
+    float vb = d5 * d2 - d1 * d6;
+
+    if (vb <= 0 && d2 >= 0 && d6 <= 0)
+        return a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+
+    if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    float denominator = 1.0f / (va + vb + vc);
+
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+static float getSquaredDistance(const BoundingVolumeNode & node, const Vector & point) {
+    float distance = 0;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float delta = max(max(node.minimum[axis] - point[axis], 0.0f), point[axis] - node.maximum[axis]);
+        distance += delta * delta;
+    }
+
+    return distance;
+}
+
+static bool overlaps(const BoundingVolumeNode & node, const BoundingBox & box) {
+    return node.minimum.x <= box.max.x && node.maximum.x >= box.min.x
+        && node.minimum.y <= box.max.y && node.maximum.y >= box.min.y
+        && node.minimum.z <= box.max.z && node.maximum.z >= box.min.z;
+}
+
+Ray::Ray(const Vector & origin, const Vector & direction, float distance)
+    : origin(origin), direction(direction), distance(distance) {}
+
+Ray::~Ray() {}
+
+Primitive::Primitive(size_t mesh, size_t triangle)
+    : mesh((uint32_t)mesh), triangle((uint32_t)triangle) {}
+
+RayHit::RayHit() : distance(FLT_MAX), u(0), v(0) {}
+
+RayHit::~RayHit() {}
+
+SurfacePoint::SurfacePoint() : point(0, 0, 0), distance(FLT_MAX) {}
+
+SurfacePoint::~SurfacePoint() {}
+
+bool BoundingVolumeNode::isLeaf() const {
+    return count != 0;
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() {
+    geometry = nullptr;
+
+    threadCount = 0;
+    leafSize = 4;
+    depth = 0;
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() {}
+
+void BoundingVolumeHierarchy::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+}
+
+size_t BoundingVolumeHierarchy::getThreadCount() const {
+    return threadCount;
+}
+
+void BoundingVolumeHierarchy::setLeafSize(size_t leafSize) {
+    this->leafSize = leafSize != 0 ? leafSize : 1;
+}
+
+size_t BoundingVolumeHierarchy::getLeafSize() const {
+    return leafSize;
+}
+
+void BoundingVolumeHierarchy::build(const Geometry * geometry) {
+    buildRange(geometry, 0, geometry != nullptr ? geometry->getMeshCount() : 0);
+}
+
+void BoundingVolumeHierarchy::build(const Geometry * geometry, size_t index) {
+    buildRange(geometry, index, index + 1);
+}
+
+void BoundingVolumeHierarchy::refit() {
+    if (nodes.empty())
+        return;
+
+    size_t workerCount = threadCount != 0 ? threadCount : virgo::getThreadCount();
+
+    parallelFor(nodes.size(), [&](size_t first, size_t last) {
+        Vector a, b, c;
+
+        for (size_t i = first; i < last; i++) {
+            BoundingVolumeNode & node = nodes[i];
+
+            if (!node.isLeaf())
+                continue;
+
+            BoundingBox bounds;
+
+            for (size_t j = node.offset; j < node.offset + node.count; j++) {
+                getTriangle(primitives[j], a, b, c);
+
+                bounds.extendBy(a);
+                bounds.extendBy(b);
+                bounds.extendBy(c);
+            }
+
+            setNode(node, bounds, node.offset, node.count);
+        }
+    }, workerCount);
+
+    for (size_t i = nodes.size(); i > 0; i--) {
+        BoundingVolumeNode & node = nodes[i - 1];
+
+        if (node.isLeaf())
+            continue;
+
+        const BoundingVolumeNode & left = nodes[node.offset];
+        const BoundingVolumeNode & right = nodes[node.offset + 1];
+
+        for (int axis = 0; axis < 3; axis++) {
+            node.minimum[axis] = min(left.minimum[axis], right.minimum[axis]);
+            node.maximum[axis] = max(left.maximum[axis], right.maximum[axis]);
+        }
+    }
+}
+
+void BoundingVolumeHierarchy::clear() {
+    geometry = nullptr;
+
+    nodes = vector<BoundingVolumeNode>();
+    primitives = vector<Primitive>();
+
+    depth = 0;
+}
+
+bool BoundingVolumeHierarchy::intersect(const Ray & ray, RayHit & hit) const {
+    if (nodes.empty())
+        return false;
+
+    Vector inverse(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+    float distance = ray.distance;
+    float entry = 0;
+    bool found = false;
+
+    if (!intersectBox(nodes[0], ray.origin, inverse, distance, entry))
+        return false;
+
+    uint32_t stack[MAXIMUM_DEPTH + 1];
+    size_t stackSize = 0;
+
+    stack[stackSize++] = 0;
+
+    Vector a, b, c;
+
+    while (stackSize != 0) {
+        const BoundingVolumeNode & node = nodes[stack[--stackSize]];
+
+        if (node.isLeaf()) {
+            for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                getTriangle(primitives[i], a, b, c);
+
+                if (intersectTriangle(ray, a, b, c, distance, hit.u, hit.v)) {
+                    hit.primitive = primitives[i];
+                    hit.distance = distance;
+
+                    found = true;
+                }
+            }
+
+            continue;
+        }
+
+        float leftEntry = 0, rightEntry = 0;
+
+        bool hitLeft = intersectBox(nodes[node.offset], ray.origin, inverse, distance, leftEntry);
+        bool hitRight = intersectBox(nodes[node.offset + 1], ray.origin, inverse, distance, rightEntry);
+
+        if (hitLeft && hitRight) {
+            if (leftEntry <= rightEntry) {
+                stack[stackSize++] = node.offset + 1;
+                stack[stackSize++] = node.offset;
+            }
+            else {
+                stack[stackSize++] = node.offset;
+                stack[stackSize++] = node.offset + 1;
+            }
+        }
+        else if (hitLeft) {
+            stack[stackSize++] = node.offset;
+        }
+        else if (hitRight) {
+            stack[stackSize++] = node.offset + 1;
+        }
+    }
+
+    return found;
+}
+
+bool BoundingVolumeHierarchy::findClosestPoint(const Vector & point, SurfacePoint & result,
+    float maximumDistance) const {
+    if (nodes.empty())
+        return false;
+
+    float bestDistance = maximumDistance < sqrt(FLT_MAX) ? maximumDistance * maximumDistance : FLT_MAX;
+    bool found = false;
+
+    uint32_t stack[MAXIMUM_DEPTH + 1];
+    size_t stackSize = 0;
+
+    stack[stackSize++] = 0;
+
+    Vector a, b, c;
+
+    while (stackSize != 0) {
+        const BoundingVolumeNode & node = nodes[stack[--stackSize]];
+
+        if (getSquaredDistance(node, point) > bestDistance)
+            continue;
+
+        if (node.isLeaf()) {
+            for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                getTriangle(primitives[i], a, b, c);
+
+                Vector closest = getClosestPoint(point, a, b, c);
+                float distance = (closest - point).length2();
+
+                if (distance <= bestDistance) {
+                    bestDistance = distance;
+
+                    result.primitive = primitives[i];
+                    result.point = closest;
+
+                    found = true;
+                }
+            }
+
+            continue;
+        }
+
+        float leftDistance = getSquaredDistance(nodes[node.offset], point);
+        float rightDistance = getSquaredDistance(nodes[node.offset + 1], point);
+
+        if (leftDistance <= rightDistance) {
+            stack[stackSize++] = node.offset + 1;
+            stack[stackSize++] = node.offset;
+        }
+        else {
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = node.offset + 1;
+        }
+    }
+
+    if (found)
+        result.distance = sqrt(bestDistance);
+
+    return found;
+}
+
+void BoundingVolumeHierarchy::findOverlaps(const BoundingBox & box, vector<Primitive> & result) const {
+    if (nodes.empty() || box.isEmpty())
+        return;
+
+    uint32_t stack[MAXIMUM_DEPTH + 1];
+    size_t stackSize = 0;
+
+    stack[stackSize++] = 0;
+
+    Vector a, b, c;
+
+    while (stackSize != 0) {
+        const BoundingVolumeNode & node = nodes[stack[--stackSize]];
+
+        if (!overlaps(node, box))
+            continue;
+
+        if (node.isLeaf()) {
+            for (size_t i = node.offset; i < node.offset + node.count; i++) {
+                getTriangle(primitives[i], a, b, c);
+
+                BoundingBox bounds(a);
+                bounds.extendBy(b);
+                bounds.extendBy(c);
+
+                if (bounds.intersects(box))
+                    result.push_back(primitives[i]);
+            }
+
+            continue;
+        }
+
+        stack[stackSize++] = node.offset + 1;
+        stack[stackSize++] = node.offset;
+    }
+}
+
+void BoundingVolumeHierarchy::getTriangle(const Primitive & primitive,
+    Vector & a, Vector & b, Vector & c) const {
+    const Triangle & triangle = geometry->meshes[primitive.mesh]->triangles[primitive.triangle];
+    const Vector * points = geometry->getPointData();
+
+    a = points[triangle.v1 - 1];
+    b = points[triangle.v2 - 1];
+    c = points[triangle.v3 - 1];
+}
+
+const Geometry * BoundingVolumeHierarchy::getGeometry() const {
+    return geometry;
+}
+
+BoundingBox BoundingVolumeHierarchy::getBounds() const {
+    if (nodes.empty())
+        return BoundingBox();
+
+    return BoundingBox(nodes[0].minimum, nodes[0].maximum);
+}
+
+const BoundingVolumeNode * BoundingVolumeHierarchy::getNodeData() const {
+    return nodes.data();
+}
+
+const Primitive * BoundingVolumeHierarchy::getPrimitiveData() const {
+    return primitives.data();
+}
+
+size_t BoundingVolumeHierarchy::getNodeCount() const {
+    return nodes.size();
+}
+
+size_t BoundingVolumeHierarchy::getPrimitiveCount() const {
+    return primitives.size();
+}
+
+size_t BoundingVolumeHierarchy::getDepth() const {
+    return depth;
+}
+
+size_t BoundingVolumeHierarchy::getMemoryUsage() const {
+    return nodes.capacity() * sizeof(BoundingVolumeNode) + primitives.capacity() * sizeof(Primitive);
+}
+
+void BoundingVolumeHierarchy::buildRange(const Geometry * geometry, size_t first, size_t last) {
+    clear();
+
+    this->geometry = geometry;
+
+    if (geometry == nullptr)
+        return;
+
+    last = min(last, geometry->getMeshCount());
+
+    vector<size_t> offsets(1, 0);
+
+    for (size_t i = first; i < last; i++)
+        offsets.push_back(offsets.back() + geometry->getMeshByIndex(i)->getTriangleCount());
+
+    size_t count = offsets.back();
+
+    if (count == 0)
+        return;
+
+    size_t workerCount = threadCount != 0 ? threadCount : virgo::getThreadCount();
+
+    BuildState state;
+    state.items.resize(count);
+    state.nodes = &nodes;
+    state.nodeCount = 1;
+    state.depth = 0;
+    state.leafSize = leafSize;
+
+    parallelFor(count, [&](size_t begin, size_t end) {
+        size_t mesh = upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin() - 1;
+        Vector a, b, c;
+
+        for (size_t i = begin; i < end; i++) {
+            while (i >= offsets[mesh + 1])
+                mesh++;
+
+            BuildItem & item = state.items[i];
+            item.primitive = Primitive(first + mesh, i - offsets[mesh]);
+
+            getTriangle(item.primitive, a, b, c);
+
+            item.bounds = BoundingBox(a);
+            item.bounds.extendBy(b);
+            item.bounds.extendBy(c);
+
+            item.centroid = item.bounds.center();
+        }
+    }, workerCount);
+
+    nodes.resize(count * 2 - 1);
+
+    vector<BuildTask> stack, tasks;
+
+    BuildTask root = { 0, 0, count, 0 };
+    stack.push_back(root);
+
+    while (!stack.empty()) {
+        BuildTask task = stack.back();
+        stack.pop_back();
+
+        if (workerCount > 1 && task.end - task.begin >= PARALLEL_THRESHOLD)
+            buildNode(state, task, workerCount, stack);
+        else
+            tasks.push_back(task);
+    }
+
+    sort(tasks.begin(), tasks.end(), [](const BuildTask & first, const BuildTask & second) {
+        return first.end - first.begin > second.end - second.begin;
+    });
+
+    atomic<size_t> next(0);
+
+    parallelFor(min(workerCount, tasks.size()), [&](size_t, size_t) {
+        vector<BuildTask> local;
+
+        for (size_t i = next++; i < tasks.size(); i = next++) {
+            local.push_back(tasks[i]);
+
+            while (!local.empty()) {
+                BuildTask task = local.back();
+                local.pop_back();
+
+                buildNode(state, task, 1, local);
+            }
+        }
+    }, workerCount);
+
+    nodes.resize(state.nodeCount);
+    nodes.shrink_to_fit();
+
+    primitives.resize(count);
+
+    for (size_t i = 0; i < count; i++)
+        primitives[i] = state.items[i].primitive;
+
+    depth = state.depth;
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
@@ -26,40 +26,319 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "data.h"
+#include <cstdint>
+#include <atomic>
 
 VIRGO_NAMESPACE_BEGIN
 
+static atomic<size_t> versionCounter(0);
+
+static size_t createVersion() {
+    return ++versionCounter;
+}
+
+static void copyNormals(const SurfaceNormals & source, SurfaceNormals & target) {
+    target.normals.assign(source.normals.begin(), source.normals.end());
+    target.indices.assign(source.indices.begin(), source.indices.end());
+
+    target.weighting = source.weighting;
+    target.creaseAngle = source.creaseAngle;
+}
+
 Triangle::Triangle(size_t v1, size_t v2, size_t v3)
     : v1(v1), v2(v2), v3(v3) {}
 
-Triangle::~Triangle() {}
+Tetrahedron::Tetrahedron(size_t v1, size_t v2, size_t v3, size_t v4)
+    : v1(v1), v2(v2), v3(v3), v4(v4) {}
 
-Mesh::Mesh() {}
+TetrahedralMesh::TetrahedralMesh(Arena * arena)
+    : tetrahedra(ArenaAllocator<Tetrahedron>(arena)),
+    neighbors(ArenaAllocator<size_t>(arena)),
+    attributes(ArenaAllocator<float>(arena)), attributeCount(0) {}
 
-Mesh::~Mesh() {
-    for (size_t i = 0; i < triangles.size(); i++) {
-        if (triangles[i] != nullptr)
-            delete triangles[i];
-    }
+TetrahedralMesh::~TetrahedralMesh() {}
+
+const Tetrahedron * TetrahedralMesh::getTetrahedronData() const {
+    return tetrahedra.data();
+}
+
+size_t * TetrahedralMesh::getIndexData() {
+    return !tetrahedra.empty() ? &tetrahedra.front().v1 : nullptr;
+}
 
-    triangles.clear();
+const size_t * TetrahedralMesh::getIndexData() const {
+    return !tetrahedra.empty() ? &tetrahedra.front().v1 : nullptr;
 }
 
-Geometry::Geometry() {}
+size_t TetrahedralMesh::getTetrahedronCount() const {
+    return tetrahedra.size();
+}
+
+bool TetrahedralMesh::hasNeighbors() const {
+    return !neighbors.empty();
+}
+
+bool TetrahedralMesh::hasAttributes() const {
+    return attributeCount != 0;
+}
+
+void TetrahedralMesh::clear() {
+    tetrahedra.clear();
+    tetrahedra.shrink_to_fit();
+
+    neighbors.clear();
+    neighbors.shrink_to_fit();
+
+    attributes.clear();
+    attributes.shrink_to_fit();
+
+    attributeCount = 0;
+}
+
+SurfaceNormals::SurfaceNormals(Arena * arena)
+    : normals(ArenaAllocator<Vector>(arena)), indices(ArenaAllocator<size_t>(arena)),
+    weighting(NormalWeighting::AreaWeighting), creaseAngle(0) {}
+
+SurfaceNormals::~SurfaceNormals() {}
+
+const Vector * SurfaceNormals::getNormalData() const {
+    return normals.data();
+}
+
+size_t SurfaceNormals::getNormalCount() const {
+    return normals.size();
+}
+
+bool SurfaceNormals::isValid(size_t triangleCount, const NormalWeighting & weighting,
+    float creaseAngle) const {
+    return indices.size() == triangleCount * 3 && this->weighting == weighting
+        && this->creaseAngle == creaseAngle;
+}
+
+void SurfaceNormals::clear() {
+    normals.clear();
+    normals.shrink_to_fit();
+
+    indices.clear();
+    indices.shrink_to_fit();
+}
+
+Mesh::Mesh(Arena * arena) : triangles(ArenaAllocator<Triangle>(arena)),
+    volume(arena), normals(arena), version(createVersion()) {}
+
+Mesh::~Mesh() {}
+
+const Triangle * Mesh::getTriangleData() const {
+    return triangles.data();
+}
+
+size_t * Mesh::getIndexData() {
+    return !triangles.empty() ? &triangles.front().v1 : nullptr;
+}
+
+const size_t * Mesh::getIndexData() const {
+    return !triangles.empty() ? &triangles.front().v1 : nullptr;
+}
+
+size_t Mesh::getTriangleCount() const {
+    return triangles.size();
+}
+
+Geometry::Geometry() : points(ArenaAllocator<Vector>(&arena)),
+    meshes(ArenaAllocator<Mesh *>(&arena)), version(createVersion()) {}
 
 Geometry::~Geometry() {
     for (size_t i = 0; i < getMeshCount(); i++) {
         if (getMeshByIndex(i) != nullptr)
-            delete getMeshByIndex(i);
+            getMeshByIndex(i)->~Mesh();
+    }
+}
+
+Mesh * Geometry::createMesh(const string & name) {
+    Mesh * mesh = new (arena.allocate(sizeof(Mesh), alignof(Mesh))) Mesh(&arena);
+    mesh->name = name;
+
+    meshes.push_back(mesh);
+    version = createVersion();
+
+    return mesh;
+}
+
+void Geometry::removeMeshByIndex(size_t index) {
+    Mesh * mesh = getMeshByIndex(index);
+
+    if (mesh != nullptr) {
+        mesh->~Mesh();
+        arena.deallocate(mesh, sizeof(Mesh));
+    }
+
+    meshes.erase(meshes.begin() + index);
+    version = createVersion();
+}
+
+void Geometry::invalidateMesh(size_t index) {
+    Mesh * mesh = getMeshByIndex(index);
+
+    if (mesh == nullptr)
+        return;
+
+    mesh->normals.clear();
+    mesh->version = createVersion();
+
+    version = createVersion();
+}
+
+void Geometry::merge(const Geometry * geometry) {
+    size_t offset = getVertexCount();
+
+    points.insert(points.end(), geometry->points.begin(), geometry->points.end());
+
+    Mesh * mesh = nullptr;
+    const Mesh * source = nullptr;
+    const Triangle * triangle = nullptr;
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
+        source = geometry->getMeshByIndex(i);
+        triangle = source->getTriangleData();
+
+        mesh = createMesh(source->name);
+        mesh->triangles.reserve(source->getTriangleCount());
+
+        for (size_t j = 0; j < source->getTriangleCount(); j++, triangle++) {
+            mesh->triangles.push_back(Triangle(triangle->v1 + offset,
+                triangle->v2 + offset, triangle->v3 + offset));
+        }
+
+        const TetrahedralMesh & volume = source->volume;
+        const Tetrahedron * tetrahedron = volume.getTetrahedronData();
+
+        mesh->volume.tetrahedra.reserve(volume.getTetrahedronCount());
+
+        for (size_t j = 0; j < volume.getTetrahedronCount(); j++, tetrahedron++) {
+            mesh->volume.tetrahedra.push_back(Tetrahedron(tetrahedron->v1 + offset,
+                tetrahedron->v2 + offset, tetrahedron->v3 + offset, tetrahedron->v4 + offset));
+        }
+
+        mesh->volume.neighbors.assign(volume.neighbors.begin(), volume.neighbors.end());
+        mesh->volume.attributes.assign(volume.attributes.begin(), volume.attributes.end());
+        mesh->volume.attributeCount = volume.attributeCount;
+
+        copyNormals(source->normals, mesh->normals);
+    }
+
+    version = createVersion();
+}
+
+void Geometry::extractMesh(size_t index, Geometry * geometry) const {
+    const Mesh * source = getMeshByIndex(index);
+
+    if (source == nullptr)
+        return;
+
+    vector<size_t> remap(getVertexCount(), 0);
+
+    size_t offset = geometry->getVertexCount();
+    size_t * target = nullptr;
+
+    const Vector * point = getPointData();
+
+    Mesh * mesh = geometry->createMesh(source->name);
+    mesh->triangles.assign(source->triangles.begin(), source->triangles.end());
+    mesh->volume.tetrahedra.assign(source->volume.tetrahedra.begin(), source->volume.tetrahedra.end());
+
+    size_t * vertices[2] = { mesh->getIndexData(), mesh->volume.getIndexData() };
+    size_t counts[2] = { mesh->getTriangleCount() * 3, mesh->volume.getTetrahedronCount() * 4 };
+
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < counts[i]; j++) {
+            target = &remap[vertices[i][j] - 1];
+
+            if (*target == 0) {
+                geometry->points.push_back(point[vertices[i][j] - 1]);
+                *target = geometry->getVertexCount() - offset;
+            }
+
+            vertices[i][j] = *target + offset;
+        }
     }
 
-    for (size_t i = 0; i < getVertexCount(); i++) {
-        if (points[i] != nullptr)
-            delete points[i];
+    mesh->volume.neighbors.assign(source->volume.neighbors.begin(), source->volume.neighbors.end());
+    mesh->volume.attributes.assign(source->volume.attributes.begin(), source->volume.attributes.end());
+    mesh->volume.attributeCount = source->volume.attributeCount;
+
+    copyNormals(source->normals, mesh->normals);
+}
+
+void Geometry::remapPoints(const vector<size_t> & positions, size_t count) {
+    vector<Vector> remapped(count);
+
+    for (size_t i = 0; i < positions.size(); i++) {
+        if (positions[i] != SIZE_MAX)
+            remapped[positions[i]] = points[i];
+    }
+
+    points.assign(remapped.begin(), remapped.end());
+
+    for (size_t i = 0; i < getMeshCount(); i++) {
+        Mesh * mesh = getMeshByIndex(i);
+
+        size_t * vertices[2] = { mesh->getIndexData(), mesh->volume.getIndexData() };
+        size_t counts[2] = { mesh->getTriangleCount() * 3, mesh->volume.getTetrahedronCount() * 4 };
+
+        for (size_t j = 0; j < 2; j++) {
+            for (size_t k = 0; k < counts[j]; k++)
+                vertices[j][k] = positions[vertices[j][k] - 1] + 1;
+        }
     }
 
-    meshes.clear();
-    points.clear();
+    version = createVersion();
+}
+
+void Geometry::removeUnusedPoints() {
+    vector<char> referenced(getVertexCount(), 0);
+
+    for (size_t i = 0; i < getMeshCount(); i++) {
+        const Mesh * mesh = getMeshByIndex(i);
+
+        const size_t * vertices[2] = { mesh->getIndexData(), mesh->volume.getIndexData() };
+        size_t counts[2] = { mesh->getTriangleCount() * 3, mesh->volume.getTetrahedronCount() * 4 };
+
+        for (size_t j = 0; j < 2; j++) {
+            for (size_t k = 0; k < counts[j]; k++)
+                referenced[vertices[j][k] - 1] = 1;
+        }
+    }
+
+    vector<size_t> positions(getVertexCount());
+    size_t count = 0;
+
+    for (size_t i = 0; i < getVertexCount(); i++)
+        positions[i] = referenced[i] ? count++ : SIZE_MAX;
+
+    if (count != getVertexCount())
+        remapPoints(positions, count);
+}
+
+void Geometry::clone(const Geometry * geometry) {
+    clear();
+    merge(geometry);
+
+    for (size_t i = 0; i < getMeshCount(); i++)
+        getMeshByIndex(i)->version = geometry->getMeshByIndex(i)->version;
+}
+
+void Geometry::clear() {
+    for (size_t i = 0; i < getMeshCount(); i++) {
+        if (getMeshByIndex(i) != nullptr)
+            getMeshByIndex(i)->~Mesh();
+    }
+
+    PointArray(ArenaAllocator<Vector>(&arena)).swap(points);
+    vector<Mesh *, ArenaAllocator<Mesh *> >(ArenaAllocator<Mesh *>(&arena)).swap(meshes);
+
+    arena.reset();
+
+    version = createVersion();
 }
 
 Mesh * Geometry::getMeshByIndex(size_t index) const {
@@ -81,50 +360,93 @@ Mesh * Geometry::getMeshByName(const char * meshName) const {
 }
 
 void Geometry::getMeshDataByIndex(size_t index,
-    vector<Vector *> & points, vector<Triangle *> & triangles) const {
+    vector<Vector> & points, vector<Triangle> & triangles) const {
+    Mesh * mesh = getMeshByIndex(index);
+
+    if (mesh == nullptr)
+        return;
+
+    size_t triangleCount = mesh->getTriangleCount();
+    size_t pointOffset = points.size();
+
+    const Triangle * triangle = mesh->getTriangleData();
+    const Vector * point = getPointData();
+
+    points.reserve(pointOffset + triangleCount * 3);
+    triangles.reserve(triangles.size() + triangleCount);
+
+    for (size_t i = 0; i < triangleCount; i++, triangle++) {
+        points.push_back(point[triangle->v1 - 1]);
+        points.push_back(point[triangle->v2 - 1]);
+        points.push_back(point[triangle->v3 - 1]);
+
+        triangles.push_back(Triangle(pointOffset + i * 3 + 1,
+            pointOffset + i * 3 + 2, pointOffset + i * 3 + 3));
+    }
+}
+
+void Geometry::getMeshDataByName(const char * meshName,
+    vector<Vector> & points, vector<Triangle> & triangles) const {
+    for (size_t i = 0; i < getMeshCount(); i++) {
+        if (getMeshByIndex(i)->name == meshName) {
+            getMeshDataByIndex(i, points, triangles);;
+            break;
+        }
+    }
+}
+
+void Geometry::getIndexedMeshDataByIndex(size_t index,
+    vector<Vector> & points, vector<Triangle> & triangles) const {
     Mesh * mesh = getMeshByIndex(index);
 
     if (mesh == nullptr)
         return;
 
-    Vector * point = nullptr;
-    Triangle * triangle = nullptr;
+    size_t triangleCount = mesh->getTriangleCount();
+    vector<size_t> remap(getVertexCount(), 0);
 
-    for (size_t i = 0; i < mesh->triangles.size(); i++) {
-        triangle = mesh->triangles[i];
+    const Triangle * triangle = mesh->getTriangleData();
+    const Vector * point = getPointData();
 
-        point = new Vector;
-        *point = *this->points[triangle->v1 - 1];
-        points.push_back(point);
+    size_t vertices[3];
+    size_t * target = nullptr;
 
-        point = new Vector;
-        *point = *this->points[triangle->v2 - 1];
-        points.push_back(point);
+    triangles.reserve(triangles.size() + triangleCount);
 
-        point = new Vector;
-        *point = *this->points[triangle->v3 - 1];
-        points.push_back(point);
+    for (size_t i = 0; i < triangleCount; i++, triangle++) {
+        vertices[0] = triangle->v1;
+        vertices[1] = triangle->v2;
+        vertices[2] = triangle->v3;
 
-        triangle = new Triangle;
+        for (size_t j = 0; j < 3; j++) {
+            target = &remap[vertices[j] - 1];
 
-        triangle->v1 = i * 3 + 1;
-        triangle->v2 = i * 3 + 2;
-        triangle->v3 = i * 3 + 3;
+            if (*target == 0) {
+                points.push_back(point[vertices[j] - 1]);
+                *target = points.size();
+            }
+
+            vertices[j] = *target;
+        }
 
-        triangles.push_back(triangle);
+        triangles.push_back(Triangle(vertices[0], vertices[1], vertices[2]));
     }
 }
 
-void Geometry::getMeshDataByName(const char * meshName,
-    vector<Vector *> & points, vector<Triangle *> & triangles) const {
+void Geometry::getIndexedMeshDataByName(const char * meshName,
+    vector<Vector> & points, vector<Triangle> & triangles) const {
     for (size_t i = 0; i < getMeshCount(); i++) {
         if (getMeshByIndex(i)->name == meshName) {
-            getMeshDataByIndex(i, points, triangles);;
+            getIndexedMeshDataByIndex(i, points, triangles);
             break;
         }
     }
 }
 
+const Vector * Geometry::getPointData() const {
+    return points.data();
+}
+
 size_t Geometry::getVertexCount() const {
     return points.size();
 }
@@ -134,14 +456,33 @@ size_t Geometry::getPolygonCount() const {
 
     for (size_t i = 0; i < getMeshCount(); i++) {
         if (getMeshByIndex(i) != nullptr)
-            polygonCount += getMeshByIndex(i)->triangles.size();
+            polygonCount += getMeshByIndex(i)->getTriangleCount();
     }
 
     return polygonCount;
 }
 
+size_t Geometry::getTetrahedronCount() const {
+    size_t tetrahedronCount = 0;
+
+    for (size_t i = 0; i < getMeshCount(); i++) {
+        if (getMeshByIndex(i) != nullptr)
+            tetrahedronCount += getMeshByIndex(i)->volume.getTetrahedronCount();
+    }
+
+    return tetrahedronCount;
+}
+
 size_t Geometry::getMeshCount() const {
     return meshes.size();
 }
 
+size_t Geometry::getReservedMemory() const {
+    return arena.getReservedSize();
+}
+
+size_t Geometry::getUsedMemory() const {
+    return arena.getUsedSize();
+}
+
 VIRGO_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,891 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "decimator.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+#define SHARED_VERTEX (SIZE_MAX - 1)
+#define MINIMUM_VALENCE 3
+#define NORMAL_THRESHOLD 0.1f
+#define SINGULAR_THRESHOLD 1e-6
+
+VIRGO_NAMESPACE_BEGIN
+
+struct Face {
+    size_t vertices[3];
+};
+
+struct Quadric {
+    Quadric() : a2(0), ab(0), ac(0), ad(0), b2(0), bc(0), bd(0), c2(0), cd(0), d2(0) {}
+
+    Quadric & operator+=(const Quadric & quadric) {
+        a2 += quadric.a2;
+        ab += quadric.ab;
+        ac += quadric.ac;
+        ad += quadric.ad;
+        b2 += quadric.b2;
+        bc += quadric.bc;
+        bd += quadric.bd;
+        c2 += quadric.c2;
+        cd += quadric.cd;
+        d2 += quadric.d2;
+
+        return *this;
+    }
+
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+};
+
+struct Collapse {
+    Collapse() : cost(DBL_MAX), first(SIZE_MAX), second(SIZE_MAX) {}
+
+    double cost;
+    size_t first, second;
+    Vector target;
+};
+
+struct MeshState {
+    vector<Vector> positions;
+    vector<Quadric> quadrics;
+    vector<char> locked;
+    vector<Face> faces;
+
+    vector<size_t> offsets;
+    vector<size_t> incidences;
+
+    vector<size_t> neighbors;
+    vector<size_t> neighborCounts;
+};
+
+static void addPlane(Quadric & quadric, const Vector & a, const Vector & b, const Vector & c) {
+    Vec3<double> first(a), second(b), third(c);
+    Vec3<double> normal = (second - first).cross(third - first);
+
+    double length = normal.length();
+
+    if (length == 0)
+        return;
+
+    normal /= length;
+
+    double distance = -normal.dot(first);
+
+    quadric.a2 += normal.x * normal.x;
+    quadric.ab += normal.x * normal.y;
+    quadric.ac += normal.x * normal.z;
+    quadric.ad += normal.x * distance;
+    quadric.b2 += normal.y * normal.y;
+    quadric.bc += normal.y * normal.z;
+    quadric.bd += normal.y * distance;
+    quadric.c2 += normal.z * normal.z;
+    quadric.cd += normal.z * distance;
+    quadric.d2 += distance * distance;
+}
+
+static double evaluate(const Quadric & quadric, const Vector & point) {
+    double x = point.x, y = point.y, z = point.z;
+
+    double value = quadric.a2 * x * x + 2.0 * quadric.ab * x * y + 2.0 * quadric.ac * x * z
+        + 2.0 * quadric.ad * x + quadric.b2 * y * y + 2.0 * quadric.bc * y * z
+        + 2.0 * quadric.bd * y + quadric.c2 * z * z + 2.0 * quadric.cd * z + quadric.d2;
+
+    return value > 0 ? value : 0;
+}
+
+static bool solve(const Quadric & quadric, Vector & point) {
+    double c00 = quadric.b2 * quadric.c2 - quadric.bc * quadric.bc;
+    double c01 = quadric.ac * quadric.bc - quadric.ab * quadric.c2;
+    double c02 = quadric.ab * quadric.bc - quadric.ac * quadric.b2;
+
+    double determinant = quadric.a2 * c00 + quadric.ab * c01 + quadric.ac * c02;
+    double trace = quadric.a2 + quadric.b2 + quadric.c2;
+
+    if (fabs(determinant) <= SINGULAR_THRESHOLD * trace * trace * trace)
+        return false;
+
+    double c11 = quadric.a2 * quadric.c2 - quadric.ac * quadric.ac;
+    double c12 = quadric.ab * quadric.ac - quadric.a2 * quadric.bc;
+    double c22 = quadric.a2 * quadric.b2 - quadric.ab * quadric.ab;
+
+    double inverse = -1.0 / determinant;
+
+    point.x = (float)((c00 * quadric.ad + c01 * quadric.bd + c02 * quadric.cd) * inverse);
+    point.y = (float)((c01 * quadric.ad + c11 * quadric.bd + c12 * quadric.cd) * inverse);
+    point.z = (float)((c02 * quadric.ad + c12 * quadric.bd + c22 * quadric.cd) * inverse);
+
+    return true;
+}
+
+static bool isLess(const Collapse & first, const Collapse & second) {
+    if (first.cost != second.cost)
+        return first.cost < second.cost;
+
+    if (first.first != second.first)
+        return first.first < second.first;
+
+    return first.second < second.second;
+}
+
+static bool isSame(const Collapse & first, const Collapse & second) {
+    return first.first == second.first && first.second == second.second;
+}
+
+static bool isEligible(const Collapse & collapse, const vector<char> & taken) {
+    return collapse.first != SIZE_MAX && !taken[collapse.first] && !taken[collapse.second];
+}
+
+static bool hasVertex(const Face & face, size_t vertex) {
+    return face.vertices[0] == vertex || face.vertices[1] == vertex || face.vertices[2] == vertex;
+}
+
+static size_t getValence(const MeshState & state, size_t vertex) {
+    return state.offsets[vertex + 1] - state.offsets[vertex];
+}
+
+static void buildAdjacency(MeshState & state) {
+    size_t vertexCount = state.positions.size();
+
+    state.offsets.assign(vertexCount + 1, 0);
+
+    for (size_t i = 0; i < state.faces.size(); i++) {
+        for (size_t j = 0; j < 3; j++)
+            state.offsets[state.faces[i].vertices[j] + 1]++;
+    }
+
+    for (size_t i = 1; i <= vertexCount; i++)
+        state.offsets[i] += state.offsets[i - 1];
+
+    state.incidences.resize(state.offsets[vertexCount]);
+
+    vector<size_t> cursors(state.offsets.begin(), state.offsets.end() - 1);
+
+    for (size_t i = 0; i < state.faces.size(); i++) {
+        for (size_t j = 0; j < 3; j++)
+            state.incidences[cursors[state.faces[i].vertices[j]]++] = i;
+    }
+}
+
+static void getNeighbors(const MeshState & state, size_t vertex, vector<size_t> & neighbors) {
+    neighbors.clear();
+
+    for (size_t i = state.offsets[vertex]; i < state.offsets[vertex + 1]; i++) {
+        const Face & face = state.faces[state.incidences[i]];
+
+        for (size_t j = 0; j < 3; j++) {
+            if (face.vertices[j] != vertex)
+                neighbors.push_back(face.vertices[j]);
+        }
+    }
+
+    sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(unique(neighbors.begin(), neighbors.end()), neighbors.end());
+}
+
+static bool isInterior(const MeshState & state, size_t vertex, vector<size_t> & neighbors) {
+    size_t first = state.offsets[vertex];
+    size_t last = state.offsets[vertex + 1];
+
+    if (first == last)
+        return false;
+
+    neighbors.clear();
+
+    for (size_t i = first; i < last; i++) {
+        const Face & face = state.faces[state.incidences[i]];
+
+        if (face.vertices[0] == face.vertices[1] || face.vertices[1] == face.vertices[2]
+            || face.vertices[2] == face.vertices[0])
+            return false;
+
+        for (size_t j = 0; j < 3; j++) {
+            if (face.vertices[j] != vertex)
+                neighbors.push_back(face.vertices[j]);
+        }
+    }
+
+    sort(neighbors.begin(), neighbors.end());
+
+    for (size_t i = 0; i < neighbors.size(); i += 2) {
+        if (i + 1 == neighbors.size() || neighbors[i] != neighbors[i + 1])
+            return false;
+
+        if (i + 2 < neighbors.size() && neighbors[i + 2] == neighbors[i])
+            return false;
+    }
+
+    size_t start = state.incidences[first];
+    size_t current = start;
+    size_t count = 1;
+
+    const Face & face = state.faces[start];
+    size_t edge = face.vertices[0] != vertex ? face.vertices[0] : face.vertices[1];
+
+    while (count <= last - first) {
+        size_t next = current;
+
+        for (size_t i = first; i < last; i++) {
+            size_t candidate = state.incidences[i];
+
+            if (candidate != current && hasVertex(state.faces[candidate], edge)) {
+                next = candidate;
+                break;
+            }
+        }
+
+        if (next == start)
+            break;
+
+        const Face & nextFace = state.faces[next];
+
+        for (size_t j = 0; j < 3; j++) {
+            if (nextFace.vertices[j] != vertex && nextFace.vertices[j] != edge) {
+                edge = nextFace.vertices[j];
+                break;
+            }
+        }
+
+        current = next;
+        count++;
+    }
+
+    return count == last - first;
+}
+
+static bool isFlipped(const MeshState & state, size_t vertex, size_t other, const Vector & target) {
+    for (size_t i = state.offsets[vertex]; i < state.offsets[vertex + 1]; i++) {
+        const Face & face = state.faces[state.incidences[i]];
+
+        if (hasVertex(face, other))
+            continue;
+
+        Vector corners[3];
+
+        for (size_t j = 0; j < 3; j++)
+            corners[j] = state.positions[face.vertices[j]];
+
+        Vector normal = (corners[1] - corners[0]).cross(corners[2] - corners[0]);
+
+        for (size_t j = 0; j < 3; j++) {
+            if (face.vertices[j] == vertex)
+                corners[j] = target;
+        }
+
+        Vector moved = (corners[1] - corners[0]).cross(corners[2] - corners[0]);
+
+        float dot = normal.dot(moved);
+        float threshold = NORMAL_THRESHOLD * NORMAL_THRESHOLD;
+
+        if (dot <= 0 || dot * dot <= threshold * normal.length2() * moved.length2())
+            return true;
+    }
+
+    return false;
+}
+
+static bool getCollapse(const MeshState & state, size_t first, size_t second, Collapse & collapse) {
+    if (state.locked[first] && state.locked[second])
+        return false;
+
+    Quadric quadric = state.quadrics[first];
+    quadric += state.quadrics[second];
+
+    const Vector & firstPoint = state.positions[first];
+    const Vector & secondPoint = state.positions[second];
+
+    Vector middle = (firstPoint + secondPoint) * 0.5f;
+    Vector target;
+
+    if (state.locked[first]) {
+        target = firstPoint;
+    }
+    else if (state.locked[second]) {
+        target = secondPoint;
+    }
+    else if (!solve(quadric, target)
+        || (target - middle).length2() > (secondPoint - firstPoint).length2()) {
+        target = middle;
+
+        if (evaluate(quadric, firstPoint) < evaluate(quadric, target))
+            target = firstPoint;
+
+        if (evaluate(quadric, secondPoint) < evaluate(quadric, target))
+            target = secondPoint;
+    }
+
+    collapse.cost = evaluate(quadric, target);
+    collapse.first = first;
+    collapse.second = second;
+    collapse.target = target;
+
+    return true;
+}
+
+static bool isValid(const MeshState & state, const Collapse & collapse) {
+    size_t first = collapse.first;
+    size_t second = collapse.second;
+
+    const size_t * firstNeighbors = state.neighbors.data() + state.offsets[first] * 2;
+    const size_t * secondNeighbors = state.neighbors.data() + state.offsets[second] * 2;
+
+    size_t firstCount = state.neighborCounts[first];
+    size_t secondCount = state.neighborCounts[second];
+
+    if (firstCount + secondCount < MINIMUM_VALENCE + 4)
+        return false;
+
+    size_t commonCount = 0;
+
+    for (size_t i = 0, j = 0; i < firstCount && j < secondCount;) {
+        if (firstNeighbors[i] < secondNeighbors[j]) {
+            i++;
+        }
+        else if (secondNeighbors[j] < firstNeighbors[i]) {
+            j++;
+        }
+        else {
+            if (getValence(state, firstNeighbors[i]) <= MINIMUM_VALENCE)
+                return false;
+
+            commonCount++;
+            i++;
+            j++;
+        }
+    }
+
+    if (commonCount != 2)
+        return false;
+
+    return !isFlipped(state, first, second, collapse.target)
+        && !isFlipped(state, second, first, collapse.target);
+}
+
+static bool isSeparated(const MeshState & state, const Collapse & collapse, const vector<char> & taken) {
+    const size_t * firstNeighbors = state.neighbors.data() + state.offsets[collapse.first] * 2;
+    const size_t * secondNeighbors = state.neighbors.data() + state.offsets[collapse.second] * 2;
+
+    size_t firstCount = state.neighborCounts[collapse.first];
+    size_t secondCount = state.neighborCounts[collapse.second];
+
+    for (size_t i = 0, j = 0; i < firstCount && j < secondCount;) {
+        if (firstNeighbors[i] < secondNeighbors[j]) {
+            i++;
+        }
+        else if (secondNeighbors[j] < firstNeighbors[i]) {
+            j++;
+        }
+        else {
+            if (taken[firstNeighbors[i]])
+                return false;
+
+            i++;
+            j++;
+        }
+    }
+
+    return true;
+}
+
+static void buildNeighbors(MeshState & state, size_t workerCount) {
+    size_t vertexCount = state.positions.size();
+
+    state.neighbors.resize(state.incidences.size() * 2);
+    state.neighborCounts.resize(vertexCount);
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        vector<size_t> neighbors;
+
+        for (size_t i = first; i < last; i++) {
+            getNeighbors(state, i, neighbors);
+            copy(neighbors.begin(), neighbors.end(), state.neighbors.begin() + state.offsets[i] * 2);
+
+            state.neighborCounts[i] = neighbors.size();
+        }
+    }, workerCount);
+}
+
+static Collapse getRegion(const MeshState & state, const vector<Collapse> & collapses,
+    const vector<char> & taken, size_t vertex) {
+    Collapse region;
+
+    if (isEligible(collapses[vertex], taken))
+        region = collapses[vertex];
+
+    const size_t * neighbors = state.neighbors.data() + state.offsets[vertex] * 2;
+
+    for (size_t i = 0; i < state.neighborCounts[vertex]; i++) {
+        const Collapse & collapse = collapses[neighbors[i]];
+
+        if (isEligible(collapse, taken) && isLess(collapse, region))
+            region = collapse;
+    }
+
+    return region;
+}
+
+static void markOwner(vector<size_t> & owners, size_t vertex, size_t mesh) {
+    if (owners[vertex] == SIZE_MAX)
+        owners[vertex] = mesh;
+    else if (owners[vertex] != mesh)
+        owners[vertex] = SHARED_VERTEX;
+}
+
+Decimator::Decimator() {
+    targetCount = 0;
+    maximumError = 0;
+
+    threadCount = 0;
+    progress = nullptr;
+
+    collapseCount = 0;
+    removedVertexCount = 0;
+}
+
+Decimator::~Decimator() {}
+
+void Decimator::setTargetCount(size_t targetCount) {
+    this->targetCount = targetCount;
+}
+
+size_t Decimator::getTargetCount() const {
+    return targetCount;
+}
+
+void Decimator::setMaximumError(float maximumError) {
+    this->maximumError = maximumError > 0 ? maximumError : 0;
+}
+
+float Decimator::getMaximumError() const {
+    return maximumError;
+}
+
+void Decimator::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+}
+
+size_t Decimator::getThreadCount() const {
+    return threadCount;
+}
+
+void Decimator::setProgress(Progress * progress) {
+    this->progress = progress;
+}
+
+Progress * Decimator::getProgress() const {
+    return progress;
+}
+
+void Decimator::decimateMesh(Geometry * geometry, size_t index) {
+    decimateRange(geometry, index, min(index + 1, geometry->getMeshCount()));
+}
+
+void Decimator::decimateAll(Geometry * geometry) {
+    decimateRange(geometry, 0, geometry->getMeshCount());
+}
+
+size_t Decimator::getCollapseCount() const {
+    return collapseCount;
+}
+
+size_t Decimator::getRemovedVertexCount() const {
+    return removedVertexCount;
+}
+
+bool Decimator::isCancelled() const {
+    return progress != nullptr && progress->isCancelled();
+}
+
+void Decimator::decimateRange(Geometry * geometry, size_t first, size_t last) {
+    size_t vertexCount = geometry->getVertexCount();
+    size_t workerCount = threadCount != 0 ? threadCount : virgo::getThreadCount();
+
+    collapseCount = 0;
+    removedVertexCount = 0;
+
+    if (first >= last || (targetCount == 0 && maximumError == 0))
+        return;
+
+    vector<size_t> owners(vertexCount, SIZE_MAX);
+    vector<char> candidates(vertexCount, 0);
+
+    size_t triangleCount = 0;
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
+        const Mesh * mesh = geometry->getMeshByIndex(i);
+        const Triangle * triangle = mesh->getTriangleData();
+        const Tetrahedron * tetrahedron = mesh->volume.getTetrahedronData();
+
+        bool selected = i >= first && i < last;
+
+        for (size_t j = 0; j < mesh->getTriangleCount(); j++, triangle++) {
+            size_t vertices[3] = { triangle->v1 - 1, triangle->v2 - 1, triangle->v3 - 1 };
+
+            for (size_t k = 0; k < 3; k++) {
+                markOwner(owners, vertices[k], i);
+                candidates[vertices[k]] |= selected;
+            }
+        }
+
+        for (size_t j = 0; j < mesh->volume.getTetrahedronCount(); j++, tetrahedron++) {
+            size_t vertices[4] = { tetrahedron->v1 - 1, tetrahedron->v2 - 1,
+                tetrahedron->v3 - 1, tetrahedron->v4 - 1 };
+
+            for (size_t k = 0; k < 4; k++) {
+                markOwner(owners, vertices[k], i);
+                candidates[vertices[k]] |= selected;
+            }
+        }
+
+        if (selected)
+            triangleCount += mesh->getTriangleCount();
+    }
+
+    vector<size_t> targets(last - first, 0);
+    size_t total = triangleCount;
+
+    if (targetCount != 0 && triangleCount != 0) {
+        total = 0;
+
+        for (size_t i = first; i < last; i++) {
+            size_t count = geometry->getMeshByIndex(i)->getTriangleCount();
+            size_t target = targetCount;
+
+            if (last - first > 1)
+                target = (size_t)((double)targetCount * count / triangleCount + 0.5);
+
+            targets[i - first] = max(target, (size_t)1);
+            total += count > targets[i - first] ? count - targets[i - first] : 0;
+        }
+    }
+
+    if (progress != nullptr) {
+        progress->setPhase(ProgressPhase::DecimatingPhase);
+        progress->setTotal(total);
+    }
+
+    vector<size_t> locals(vertexCount, SIZE_MAX);
+
+    for (size_t i = first; i < last; i++) {
+        if (!simplifyMesh(geometry, i, targets[i - first], owners, locals, workerCount))
+            return;
+    }
+
+    if (collapseCount == 0)
+        return;
+
+    vector<char> referenced(vertexCount, 0);
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
+        const Mesh * mesh = geometry->getMeshByIndex(i);
+        const Triangle * triangle = mesh->getTriangleData();
+        const Tetrahedron * tetrahedron = mesh->volume.getTetrahedronData();
+
+        for (size_t j = 0; j < mesh->getTriangleCount(); j++, triangle++) {
+            referenced[triangle->v1 - 1] = 1;
+            referenced[triangle->v2 - 1] = 1;
+            referenced[triangle->v3 - 1] = 1;
+        }
+
+        for (size_t j = 0; j < mesh->volume.getTetrahedronCount(); j++, tetrahedron++) {
+            referenced[tetrahedron->v1 - 1] = 1;
+            referenced[tetrahedron->v2 - 1] = 1;
+            referenced[tetrahedron->v3 - 1] = 1;
+            referenced[tetrahedron->v4 - 1] = 1;
+        }
+    }
+
+    vector<size_t> & positions = locals;
+    size_t count = 0;
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (candidates[i] && !referenced[i])
+            positions[i] = SIZE_MAX;
+        else
+            positions[i] = count++;
+    }
+
+    removedVertexCount = vertexCount - count;
+
+    if (removedVertexCount != 0)
+        geometry->remapPoints(positions, count);
+}
+
+bool Decimator::simplifyMesh(Geometry * geometry, size_t index, size_t target,
+    const vector<size_t> & owners, vector<size_t> & locals, size_t workerCount) {
+    Mesh * mesh = geometry->getMeshByIndex(index);
+    size_t faceCount = mesh->getTriangleCount();
+
+    if (faceCount == 0 || (target != 0 && faceCount <= target))
+        return true;
+
+    MeshState state;
+    vector<size_t> vertices;
+
+    const Triangle * triangle = mesh->getTriangleData();
+    state.faces.resize(faceCount);
+
+    for (size_t i = 0; i < faceCount; i++, triangle++) {
+        size_t corners[3] = { triangle->v1 - 1, triangle->v2 - 1, triangle->v3 - 1 };
+
+        for (size_t j = 0; j < 3; j++) {
+            if (locals[corners[j]] == SIZE_MAX) {
+                locals[corners[j]] = vertices.size();
+                vertices.push_back(corners[j]);
+            }
+
+            state.faces[i].vertices[j] = locals[corners[j]];
+        }
+    }
+
+    size_t vertexCount = vertices.size();
+    const Vector * points = geometry->getPointData();
+
+    state.positions.resize(vertexCount);
+    state.quadrics.resize(vertexCount);
+    state.locked.resize(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        state.positions[i] = points[vertices[i]];
+        state.locked[i] = owners[vertices[i]] == SHARED_VERTEX;
+
+        locals[vertices[i]] = SIZE_MAX;
+    }
+
+    buildAdjacency(state);
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        vector<size_t> neighbors;
+
+        for (size_t i = first; i < last; i++) {
+            if (!isInterior(state, i, neighbors))
+                state.locked[i] = 1;
+
+            for (size_t j = state.offsets[i]; j < state.offsets[i + 1]; j++) {
+                const Face & face = state.faces[state.incidences[j]];
+
+                addPlane(state.quadrics[i], state.positions[face.vertices[0]],
+                    state.positions[face.vertices[1]], state.positions[face.vertices[2]]);
+            }
+        }
+    }, workerCount);
+
+    double maximumCost = maximumError > 0 ? (double)maximumError * maximumError : DBL_MAX;
+
+    vector<Collapse> collapses(vertexCount);
+    vector<size_t> candidates, selection;
+    vector<char> taken, flags;
+
+    size_t meshCollapseCount = 0;
+
+    while (target == 0 || faceCount > target) {
+        if (isCancelled())
+            return false;
+
+        buildNeighbors(state, workerCount);
+
+        parallelFor(vertexCount, [&](size_t first, size_t last) {
+            vector<Collapse> options;
+
+            for (size_t i = first; i < last; i++) {
+                const size_t * neighbors = state.neighbors.data() + state.offsets[i] * 2;
+
+                options.clear();
+
+                for (size_t j = 0; j < state.neighborCounts[i]; j++) {
+                    Collapse option;
+
+                    if (getCollapse(state, min(i, neighbors[j]), max(i, neighbors[j]), option)
+                        && option.cost <= maximumCost)
+                        options.push_back(option);
+                }
+
+                sort(options.begin(), options.end(), isLess);
+                collapses[i] = Collapse();
+
+                for (size_t j = 0; j < options.size(); j++) {
+                    if (isValid(state, options[j])) {
+                        collapses[i] = options[j];
+                        break;
+                    }
+                }
+            }
+        }, workerCount);
+
+        candidates.clear();
+        selection.clear();
+        taken.assign(vertexCount, 0);
+
+        for (size_t i = 0; i < vertexCount; i++) {
+            if (collapses[i].first == i)
+                candidates.push_back(i);
+        }
+
+        while (!candidates.empty()) {
+            flags.assign(candidates.size(), 0);
+
+            parallelFor(candidates.size(), [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; i++) {
+                    const Collapse & collapse = collapses[candidates[i]];
+
+                    flags[i] = isSame(collapses[collapse.second], collapse)
+                        && isSame(getRegion(state, collapses, taken, collapse.first), collapse)
+                        && isSame(getRegion(state, collapses, taken, collapse.second), collapse);
+                }
+            }, workerCount);
+
+            size_t selectionCount = selection.size();
+
+            for (size_t i = 0; i < candidates.size(); i++) {
+                if (!flags[i])
+                    continue;
+
+                const Collapse & collapse = collapses[candidates[i]];
+                size_t endpoints[2] = { collapse.first, collapse.second };
+
+                if (!isEligible(collapse, taken) || !isSeparated(state, collapse, taken))
+                    continue;
+
+                selection.push_back(candidates[i]);
+
+                for (size_t j = 0; j < 2; j++) {
+                    size_t vertex = endpoints[j];
+                    const size_t * neighbors = state.neighbors.data() + state.offsets[vertex] * 2;
+
+                    taken[vertex] = 1;
+
+                    for (size_t k = 0; k < state.neighborCounts[vertex]; k++)
+                        taken[neighbors[k]] = 1;
+                }
+            }
+
+            if (selection.size() == selectionCount)
+                break;
+
+            size_t count = 0;
+
+            for (size_t i = 0; i < candidates.size(); i++) {
+                const Collapse & collapse = collapses[candidates[i]];
+
+                if (isEligible(collapse, taken) && isSeparated(state, collapse, taken))
+                    candidates[count++] = candidates[i];
+            }
+
+            candidates.resize(count);
+        }
+
+        if (selection.empty())
+            break;
+
+        if (target != 0) {
+            size_t limit = max((faceCount - target + 1) / 2, (size_t)1);
+
+            if (selection.size() > limit) {
+                sort(selection.begin(), selection.end(), [&](size_t first, size_t second) {
+                    return isLess(collapses[first], collapses[second]);
+                });
+
+                selection.resize(limit);
+            }
+        }
+
+        parallelFor(selection.size(), [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                const Collapse & collapse = collapses[selection[i]];
+
+                size_t kept = collapse.first;
+                size_t removed = collapse.second;
+
+                if (state.locked[removed])
+                    swap(kept, removed);
+
+                state.positions[kept] = collapse.target;
+                state.quadrics[kept] += state.quadrics[removed];
+
+                for (size_t j = state.offsets[removed]; j < state.offsets[removed + 1]; j++) {
+                    Face & face = state.faces[state.incidences[j]];
+
+                    if (hasVertex(face, kept)) {
+                        face.vertices[0] = SIZE_MAX;
+                        continue;
+                    }
+
+                    for (size_t k = 0; k < 3; k++) {
+                        if (face.vertices[k] == removed)
+                            face.vertices[k] = kept;
+                    }
+                }
+            }
+        }, workerCount);
+
+        size_t count = 0;
+
+        for (size_t i = 0; i < state.faces.size(); i++) {
+            if (state.faces[i].vertices[0] != SIZE_MAX)
+                state.faces[count++] = state.faces[i];
+        }
+
+        state.faces.resize(count);
+
+        if (progress != nullptr)
+            progress->advance(faceCount - count);
+
+        faceCount = count;
+        meshCollapseCount += selection.size();
+
+        buildAdjacency(state);
+    }
+
+    if (meshCollapseCount == 0)
+        return true;
+
+    Vector * data = geometry->points.data();
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (getValence(state, i) != 0)
+            data[vertices[i]] = state.positions[i];
+    }
+
+    mesh->triangles.resize(faceCount);
+
+    for (size_t i = 0; i < faceCount; i++) {
+        const Face & face = state.faces[i];
+
+        mesh->triangles[i] = Triangle(vertices[face.vertices[0]] + 1,
+            vertices[face.vertices[1]] + 1, vertices[face.vertices[2]] + 1);
+    }
+
+    mesh->volume.clear();
+    geometry->invalidateMesh(index);
+    collapseCount += meshCollapseCount;
+
+    return true;
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
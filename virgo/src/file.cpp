@@ -26,108 +26,885 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "file.h"
+#include "numeric.h"
+#include "parallel.h"
+#include "timer.h"
 #include <iostream>
-#include <string>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+
+#define CHUNK_SIZE (1 << 20)
+#define WRITE_CHUNK_SIZE (1 << 16)
+#define MAX_LINE_SIZE 96
+#define DEFAULT_GROUP_NAME "default"
+
+#define BINARY_MAGIC 0x4F475256
+#define BINARY_VERSION 2
+#define BINARY_MESH_SIZE_V1 32
+#define BINARY_ALIGNMENT 64
 
 VIRGO_NAMESPACE_BEGIN
 
+struct ObjectChunk {
+    vector<Vector> points;
+    vector<Triangle> triangles;
+
+    vector<size_t> groupOffsets;
+    vector<string> groupNames;
+};
+
+struct BinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+
+    uint64_t vertexCount;
+    uint64_t meshCount;
+
+    uint64_t meshTableOffset;
+    uint64_t nameTableOffset;
+    uint64_t vertexOffset;
+
+    uint64_t reserved[2];
+};
+
+struct BinaryMesh {
+    uint64_t nameOffset;
+    uint64_t nameLength;
+
+    uint64_t triangleCount;
+    uint64_t triangleOffset;
+
+    uint64_t tetrahedronCount;
+    uint64_t tetrahedronOffset;
+    uint64_t neighborOffset;
+
+    uint64_t attributeCount;
+    uint64_t attributeOffset;
+};
+
+struct ObjectSegment {
+    size_t chunk;
+    size_t begin, end;
+
+    Mesh * mesh;
+    size_t offset;
+};
+
+static uint64_t align(uint64_t offset) {
+    return (offset + BINARY_ALIGNMENT - 1) & ~(uint64_t)(BINARY_ALIGNMENT - 1);
+}
+
+static bool fits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t size) {
+    return offset <= size && count <= (size - offset) / elementSize;
+}
+
+static void copyIndices(size_t * target, const uint64_t * source, uint64_t count) {
+    if (sizeof(size_t) == sizeof(uint64_t)) {
+        if (count != 0)
+            memcpy(target, source, (size_t)count * sizeof(uint64_t));
+    }
+    else {
+        for (uint64_t i = 0; i < count; i++)
+            target[i] = (size_t)source[i];
+    }
+}
+
+static bool checkIndices(const size_t * indices, size_t count, uint64_t vertexCount) {
+    for (size_t i = 0; i < count; i++) {
+        if (indices[i] == 0 || indices[i] > vertexCount)
+            return false;
+    }
+
+    return true;
+}
+
+static bool hasExtension(const char * filename, const char * extension) {
+    size_t filenameLength = strlen(filename);
+    size_t extensionLength = strlen(extension);
+
+    if (filenameLength < extensionLength)
+        return false;
+
+    filename += filenameLength - extensionLength;
+
+    for (size_t i = 0; i < extensionLength; i++) {
+        if (tolower((unsigned char)filename[i]) != extension[i])
+            return false;
+    }
+
+    return true;
+}
+
+static bool isCancelled(const Progress * progress) {
+    return progress != nullptr && progress->isCancelled();
+}
+
+static const char * findLineEnd(const char * begin, const char * end) {
+    const char * lineEnd = (const char *)memchr(begin, '\n', end - begin);
+    return lineEnd != nullptr ? lineEnd : end;
+}
+
+static const char * skipWhitespace(const char * begin, const char * end) {
+    while (begin != end && (*begin == ' ' || *begin == '\t' || *begin == '\r'))
+        begin++;
+
+    return begin;
+}
+
+static const char * skipToken(const char * begin, const char * end) {
+    while (begin != end && *begin != ' ' && *begin != '\t' && *begin != '\r')
+        begin++;
+
+    return begin;
+}
+
+static void parseVertex(const char * begin, const char * end, Vector & point) {
+    float * coordinates[3] = { &point.x, &point.y, &point.z };
+
+    for (size_t i = 0; i < 3; i++) {
+        begin = skipWhitespace(begin, end);
+        *coordinates[i] = 0;
+        begin = skipToken(parseFloat(begin, end, *coordinates[i]), end);
+    }
+}
+
+static bool parseFace(const char * begin, const char * end, Triangle & triangle) {
+    size_t * vertices[3] = { &triangle.v1, &triangle.v2, &triangle.v3 };
+    const char * current = nullptr;
+
+    for (size_t i = 0; i < 3; i++) {
+        begin = skipWhitespace(begin, end);
+        current = parseUInt(begin, end, *vertices[i]);
+
+        if (current == begin || *vertices[i] == 0)
+            return false;
+
+        begin = skipToken(current, end);
+    }
+
+    return true;
+}
+
+static char getLineType(const char * line, const char * lineEnd) {
+    if (lineEnd - line < 2 || line[1] != ' ')
+        return '\0';
+
+    return line[0];
+}
+
+static char parseLine(const char * line, const char * lineEnd, Vector & point, Triangle & triangle,
+    string & name) {
+    char type = getLineType(line, lineEnd);
+
+    switch (type) {
+        case 'v':
+            parseVertex(line + 2, lineEnd, point);
+            break;
+        case 'g': {
+            const char * nameEnd = lineEnd;
+
+            if (nameEnd != line + 2 && nameEnd[-1] == '\r')
+                nameEnd--;
+
+            name.assign(line + 2, nameEnd);
+
+            break;
+        }
+        case 'f':
+            if (!parseFace(line + 2, lineEnd, triangle))
+                return '\0';
+
+            break;
+        default:
+            return '\0';
+    }
+
+    return type;
+}
+
+FileStatistics::FileStatistics(size_t size, double time)
+    : size(size), time(time) {}
+
+FileStatistics::~FileStatistics() {}
+
+double FileStatistics::getThroughput() const {
+    if (time <= 0)
+        return 0;
+
+    return size / 1048576.0 / time;
+}
+
 File::File() {
     file = new fstream;
+    mappedFile = new MappedFile;
+
+    format = FileFormat::Object;
+    precision = 0;
+    threadCount = 0;
+    progress = nullptr;
 }
 
 File::~File() {
     close();
+
     delete file;
+    delete mappedFile;
 }
 
 void File::open(const char * filename, const FileMode & mode) {
     int filemode;
 
+    format = hasExtension(filename, ".vgo") ? FileFormat::Binary : FileFormat::Object;
+
     switch (mode) {
         case FileMode::Read:
-            filemode = fstream::in;
-            break;
+            mappedFile->open(filename);
+            return;
         case FileMode::Write:
-            filemode = fstream::out;
+            filemode = fstream::out | fstream::binary;
             break;
         default:
-            filemode = fstream::in | fstream::out | fstream::app;
+            mappedFile->open(filename);
+            filemode = fstream::in | fstream::out | fstream::app | fstream::binary;
     }
 
     file->open(filename, (fstream::openmode)filemode);
 }
 
 void File::close() {
-    if (isOpen()) file->close();
+    if (file->is_open()) file->close();
+    if (mappedFile->isOpen()) mappedFile->close();
 }
 
 bool File::isOpen() const {
-    return file->is_open();
+    return file->is_open() || mappedFile->isOpen();
 }
 
-void File::read(Geometry * geometry) const {
-    if (!isOpen()) return;
+bool File::read(Geometry * geometry) {
+    if (!mappedFile->isOpen()) return false;
+
+    bool status = true;
 
-    string line, name;
-    size_t i = 0;
+    Timer timer;
+
+    const char * begin = mappedFile->getData();
+    const char * end = begin + mappedFile->getSize();
+
+    if (progress != nullptr) {
+        progress->setPhase(ProgressPhase::ParsingPhase);
+        progress->setTotal(mappedFile->getSize());
+    }
+
+    if (mappedFile->getSize() >= sizeof(BinaryHeader)
+        && ((const BinaryHeader *)begin)->magic == BINARY_MAGIC) {
+        format = FileFormat::Binary;
+
+        status = parseBinary(begin, end, geometry);
+
+        if (progress != nullptr)
+            progress->advance(mappedFile->getSize());
+    }
+    else {
+        size_t chunkCount = threadCount != 0 ? threadCount : virgo::getThreadCount();
+
+        if (chunkCount > mappedFile->getSize() / CHUNK_SIZE)
+            chunkCount = mappedFile->getSize() / CHUNK_SIZE;
+
+        format = FileFormat::Object;
+
+        if (chunkCount > 1)
+            parseObjectChunks(begin, end, geometry, chunkCount);
+        else
+            parseObject(begin, end, geometry);
+    }
+
+    statistics = FileStatistics(mappedFile->getSize(), timer.getElapsedTime());
+
+    return status;
+}
+
+bool File::write(const Geometry * geometry) {
+    if (!file->is_open()) return false;
+
+    if (progress != nullptr) {
+        size_t total = geometry->getVertexCount() + geometry->getPolygonCount();
+
+        if (format == FileFormat::Binary)
+            total += geometry->getTetrahedronCount();
+
+        progress->setPhase(ProgressPhase::WritingPhase);
+        progress->setTotal(total);
+    }
+
+    if (format == FileFormat::Binary)
+        writeBinary(geometry);
+    else
+        writeObject(geometry);
+
+    file->flush();
+
+    return !file->fail();
+}
+
+void File::setFormat(const FileFormat & format) {
+    this->format = format;
+}
+
+FileFormat File::getFormat() const {
+    return format;
+}
+
+void File::setPrecision(int precision) {
+    this->precision = precision;
+}
+
+int File::getPrecision() const {
+    return precision;
+}
+
+void File::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+}
+
+size_t File::getThreadCount() const {
+    return threadCount;
+}
+
+void File::setProgress(Progress * progress) {
+    this->progress = progress;
+}
+
+Progress * File::getProgress() const {
+    return progress;
+}
+
+const FileStatistics & File::getStatistics() const {
+    return statistics;
+}
+
+void File::parseObject(const char * begin, const char * end, Geometry * geometry) const {
+    size_t vertexCount = 0;
+    vector<size_t> faceCounts(1, 0);
+
+    const char * line = nullptr;
+    const char * lineEnd = nullptr;
+
+    for (line = begin; line < end; line = lineEnd + 1) {
+        lineEnd = findLineEnd(line, end);
+
+        switch (getLineType(line, lineEnd)) {
+            case 'v':
+                vertexCount++;
+                break;
+            case 'g':
+                faceCounts.push_back(0);
+                break;
+            case 'f':
+                faceCounts.back()++;
+                break;
+        }
+    }
+
+    geometry->points.reserve(geometry->getVertexCount() + vertexCount);
 
     Mesh * mesh = nullptr;
+    size_t group = 0;
+
+    Vector point;
+    Triangle triangle;
+    string name;
+
+    const char * mark = begin;
 
-    Vector * point = nullptr;
-    Triangle * triangle = nullptr;
+    for (line = begin; line < end; line = lineEnd + 1) {
+        if (progress != nullptr && line - mark >= CHUNK_SIZE) {
+            progress->advance(line - mark);
+            mark = line;
 
-    while (getline(*file, line)) {
-        if (line.substr(0, 2) == "v ") {
-            point = new Vector;
+            if (progress->isCancelled())
+                return;
+        }
+
+        lineEnd = findLineEnd(line, end);
+
+        switch (parseLine(line, lineEnd, point, triangle, name)) {
+            case 'v':
+                geometry->points.push_back(point);
+                break;
+            case 'g':
+                mesh = geometry->createMesh(name);
+                mesh->triangles.reserve(faceCounts[++group]);
 
-            sscanf(line.c_str(), "%*s %f %f %f", &point->x, &point->y, &point->z);
+                break;
+            case 'f':
+                if (mesh == nullptr) {
+                    mesh = geometry->createMesh(DEFAULT_GROUP_NAME);
+                    mesh->triangles.reserve(faceCounts[0]);
+                }
 
-            geometry->points.push_back(point);
+                mesh->triangles.push_back(triangle);
+
+                break;
         }
-        else if (line.substr(0, 2) == "g ") {
-            geometry->meshes.push_back(new Mesh);
-            mesh = geometry->getMeshByIndex(i);
+    }
+
+    if (progress != nullptr)
+        progress->advance(end - mark);
+}
+
+void File::parseObjectChunks(const char * begin, const char * end, Geometry * geometry,
+    size_t chunkCount) const {
+    vector<const char *> boundaries(chunkCount + 1, end);
+    boundaries[0] = begin;
+
+    for (size_t i = 1; i < chunkCount; i++) {
+        const char * boundary = begin + (end - begin) * i / chunkCount;
+
+        if (boundary < boundaries[i - 1])
+            boundary = boundaries[i - 1];
+
+        boundary = findLineEnd(boundary, end);
+        boundaries[i] = boundary != end ? boundary + 1 : end;
+    }
+
+    vector<ObjectChunk> chunks(chunkCount);
+
+    parallelFor(chunkCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            ObjectChunk & chunk = chunks[i];
+
+            const char * line = nullptr;
+            const char * lineEnd = nullptr;
+
+            size_t vertexCount = 0, faceCount = 0;
+
+            for (line = boundaries[i]; line < boundaries[i + 1]; line = lineEnd + 1) {
+                lineEnd = findLineEnd(line, boundaries[i + 1]);
 
-            mesh->name = line.substr(2);
+                switch (getLineType(line, lineEnd)) {
+                    case 'v':
+                        vertexCount++;
+                        break;
+                    case 'f':
+                        faceCount++;
+                        break;
+                }
+            }
 
-            i++;
+            chunk.points.reserve(vertexCount);
+            chunk.triangles.reserve(faceCount);
+
+            Vector point;
+            Triangle triangle;
+            string name;
+
+            const char * mark = boundaries[i];
+
+            for (line = boundaries[i]; line < boundaries[i + 1]; line = lineEnd + 1) {
+                if (progress != nullptr && line - mark >= CHUNK_SIZE) {
+                    progress->advance(line - mark);
+                    mark = line;
+
+                    if (progress->isCancelled())
+                        break;
+                }
+
+                lineEnd = findLineEnd(line, boundaries[i + 1]);
+
+                switch (parseLine(line, lineEnd, point, triangle, name)) {
+                    case 'v':
+                        chunk.points.push_back(point);
+                        break;
+                    case 'g':
+                        chunk.groupOffsets.push_back(chunk.triangles.size());
+                        chunk.groupNames.push_back(name);
+
+                        break;
+                    case 'f':
+                        chunk.triangles.push_back(triangle);
+                        break;
+                }
+            }
+
+            if (progress != nullptr && line >= boundaries[i + 1])
+                progress->advance(boundaries[i + 1] - mark);
         }
-        else if (line.substr(0, 2) == "f ") {
-            triangle = new Triangle;
+    }, chunkCount);
+
+    if (isCancelled(progress))
+        return;
+
+    vector<size_t> vertexOffsets(chunkCount + 1, geometry->getVertexCount());
+    vector<ObjectSegment> segments;
+
+    Mesh * mesh = nullptr;
+    size_t triangleCount = 0;
+
+    ObjectSegment segment;
+
+    for (size_t i = 0; i < chunkCount; i++) {
+        const ObjectChunk & chunk = chunks[i];
+        size_t groupCount = chunk.groupOffsets.size();
+
+        vertexOffsets[i + 1] = vertexOffsets[i] + chunk.points.size();
+
+        for (size_t j = 0; j <= groupCount; j++) {
+            segment.chunk = i;
+            segment.begin = j != 0 ? chunk.groupOffsets[j - 1] : 0;
+            segment.end = j != groupCount ? chunk.groupOffsets[j] : chunk.triangles.size();
 
-            sscanf(line.c_str(), "%*s %zu %zu %zu", &triangle->v1, &triangle->v2, &triangle->v3);
+            if (j != 0 || (mesh == nullptr && segment.end != 0)) {
+                if (mesh != nullptr)
+                    mesh->triangles.resize(triangleCount);
 
-            mesh->triangles.push_back(triangle);
+                mesh = geometry->createMesh(j != 0 ? chunk.groupNames[j - 1] : DEFAULT_GROUP_NAME);
+                triangleCount = 0;
+            }
+
+            if (segment.begin == segment.end)
+                continue;
+
+            segment.mesh = mesh;
+            segment.offset = triangleCount;
+
+            triangleCount += segment.end - segment.begin;
+            segments.push_back(segment);
         }
-        else {
-            continue;
+    }
+
+    if (mesh != nullptr)
+        mesh->triangles.resize(triangleCount);
+
+    geometry->points.resize(vertexOffsets[chunkCount]);
+
+    parallelFor(chunkCount + segments.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            if (i < chunkCount) {
+                const ObjectChunk & chunk = chunks[i];
+
+                copy(chunk.points.begin(), chunk.points.end(),
+                    geometry->points.begin() + vertexOffsets[i]);
+            }
+            else {
+                const ObjectSegment & segment = segments[i - chunkCount];
+                const ObjectChunk & chunk = chunks[segment.chunk];
+
+                copy(chunk.triangles.begin() + segment.begin, chunk.triangles.begin() + segment.end,
+                    segment.mesh->triangles.begin() + segment.offset);
+            }
         }
+    }, chunkCount);
+}
+
+bool File::parseBinary(const char * begin, const char * end, Geometry * geometry) const {
+    BinaryHeader header;
+    memcpy(&header, begin, sizeof(BinaryHeader));
+
+    uint64_t size = end - begin;
+    uint64_t meshSize = header.version == 1 ? BINARY_MESH_SIZE_V1 : sizeof(BinaryMesh);
+
+    if (header.version < 1 || header.version > BINARY_VERSION
+        || !fits(header.meshTableOffset, header.meshCount, meshSize, size)
+        || !fits(header.vertexOffset, header.vertexCount, sizeof(Vector), size)
+        || header.nameTableOffset > size)
+        return false;
+
+    vector<BinaryMesh> meshTable((size_t)header.meshCount);
+
+    for (size_t i = 0; i < meshTable.size(); i++) {
+        BinaryMesh & binaryMesh = meshTable[i];
+
+        memset(&binaryMesh, 0, sizeof(BinaryMesh));
+        memcpy(&binaryMesh, begin + header.meshTableOffset + i * meshSize, (size_t)meshSize);
+
+        if (!fits(header.nameTableOffset + binaryMesh.nameOffset, binaryMesh.nameLength, 1, size)
+            || binaryMesh.nameOffset > size
+            || !fits(binaryMesh.triangleOffset, binaryMesh.triangleCount, sizeof(uint64_t) * 3, size)
+            || !fits(binaryMesh.tetrahedronOffset, binaryMesh.tetrahedronCount, sizeof(uint64_t) * 4, size)
+            || (binaryMesh.neighborOffset != 0
+                && !fits(binaryMesh.neighborOffset, binaryMesh.tetrahedronCount, sizeof(uint64_t) * 4, size))
+            || (binaryMesh.attributeCount != 0
+                && (binaryMesh.attributeCount > size
+                    || !fits(binaryMesh.attributeOffset, binaryMesh.tetrahedronCount,
+                        sizeof(float) * binaryMesh.attributeCount, size))))
+            return false;
     }
+
+    size_t vertexOffset = geometry->getVertexCount();
+    size_t meshOffset = geometry->getMeshCount();
+
+    geometry->points.resize(vertexOffset + (size_t)header.vertexCount);
+
+    for (size_t i = 0; i < meshTable.size(); i++) {
+        const BinaryMesh & binaryMesh = meshTable[i];
+        const char * name = begin + header.nameTableOffset + binaryMesh.nameOffset;
+
+        Mesh * mesh = geometry->createMesh(string(name, (size_t)binaryMesh.nameLength));
+        mesh->triangles.resize((size_t)binaryMesh.triangleCount);
+
+        TetrahedralMesh & volume = mesh->volume;
+        volume.tetrahedra.resize((size_t)binaryMesh.tetrahedronCount);
+
+        if (binaryMesh.neighborOffset != 0)
+            volume.neighbors.resize((size_t)binaryMesh.tetrahedronCount * 4);
+
+        volume.attributeCount = (size_t)binaryMesh.attributeCount;
+        volume.attributes.resize((size_t)(binaryMesh.tetrahedronCount * binaryMesh.attributeCount));
+    }
+
+    atomic<bool> valid(true);
+
+    parallelFor(meshTable.size() + 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last && valid; i++) {
+            if (i == 0) {
+                if (header.vertexCount != 0)
+                    memcpy((void *)&geometry->points[vertexOffset], begin + header.vertexOffset,
+                        (size_t)header.vertexCount * sizeof(Vector));
+
+                continue;
+            }
+
+            const BinaryMesh & binaryMesh = meshTable[i - 1];
+            Mesh * mesh = geometry->getMeshByIndex(meshOffset + i - 1);
+            TetrahedralMesh & volume = mesh->volume;
+
+            copyIndices(mesh->getIndexData(),
+                (const uint64_t *)(begin + binaryMesh.triangleOffset), binaryMesh.triangleCount * 3);
+            copyIndices(volume.getIndexData(),
+                (const uint64_t *)(begin + binaryMesh.tetrahedronOffset), binaryMesh.tetrahedronCount * 4);
+
+            if (!checkIndices(mesh->getIndexData(), mesh->getTriangleCount() * 3, header.vertexCount)
+                || !checkIndices(volume.getIndexData(), volume.getTetrahedronCount() * 4,
+                    header.vertexCount)) {
+                valid = false;
+                break;
+            }
+
+            if (volume.hasNeighbors())
+                copyIndices(volume.neighbors.data(),
+                    (const uint64_t *)(begin + binaryMesh.neighborOffset), binaryMesh.tetrahedronCount * 4);
+
+            if (!volume.attributes.empty())
+                memcpy(volume.attributes.data(), begin + binaryMesh.attributeOffset,
+                    volume.attributes.size() * sizeof(float));
+        }
+    }, threadCount);
+
+    if (!valid) {
+        while (geometry->getMeshCount() > meshOffset)
+            geometry->removeMeshByIndex(geometry->getMeshCount() - 1);
+
+        geometry->points.resize(vertexOffset);
+    }
+
+    return valid;
 }
 
-void File::write(const Geometry * geometry) {
-    if (!isOpen()) return;
+void File::writeObject(const Geometry * geometry) {
+    writeObjectChunks(geometry->getPointData(), nullptr, geometry->getVertexCount());
+
+    if (isCancelled(progress))
+        return;
+
+    string line;
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
+        const Mesh * mesh = geometry->getMeshByIndex(i);
 
-    const Mesh * mesh = nullptr;
+        line = "g " + mesh->name + "\n";
+        file->write(line.data(), line.size());
 
-    Vector * point;
-    Triangle * triangle;
+        writeObjectChunks(nullptr, mesh->getTriangleData(), mesh->getTriangleCount());
 
-    for (size_t i = 0; i < geometry->getVertexCount(); i++) {
-        point = geometry->points[i];
-        *file << "v " << point->x << " " << point->y << " " << point->z << endl;
+        if (isCancelled(progress))
+            return;
     }
+}
+
+void File::writeObjectChunks(const Vector * points, const Triangle * triangles, size_t count) {
+    size_t chunkCount = (count + WRITE_CHUNK_SIZE - 1) / WRITE_CHUNK_SIZE;
+    size_t waveSize = threadCount != 0 ? threadCount : virgo::getThreadCount();
+
+    vector<vector<char> > buffers(waveSize < chunkCount ? waveSize : chunkCount);
+    vector<size_t> sizes(buffers.size());
+
+    for (size_t wave = 0; wave < chunkCount; wave += buffers.size()) {
+        size_t waveCount = chunkCount - wave < buffers.size() ? chunkCount - wave : buffers.size();
+
+        parallelFor(waveCount, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                size_t begin = (wave + i) * WRITE_CHUNK_SIZE;
+                size_t end = begin + WRITE_CHUNK_SIZE < count ? begin + WRITE_CHUNK_SIZE : count;
+
+                vector<char> & buffer = buffers[i];
+                buffer.resize((end - begin) * MAX_LINE_SIZE);
+
+                char * current = buffer.data();
+
+                for (size_t j = begin; j < end; j++) {
+                    if (points != nullptr) {
+                        const Vector & point = points[j];
+
+                        *current++ = 'v';
+                        *current++ = ' ';
+                        current = formatFloat(current, point.x, precision);
+                        *current++ = ' ';
+                        current = formatFloat(current, point.y, precision);
+                        *current++ = ' ';
+                        current = formatFloat(current, point.z, precision);
+                    }
+                    else {
+                        const Triangle & triangle = triangles[j];
+
+                        *current++ = 'f';
+                        *current++ = ' ';
+                        current = formatUInt(current, triangle.v1);
+                        *current++ = ' ';
+                        current = formatUInt(current, triangle.v2);
+                        *current++ = ' ';
+                        current = formatUInt(current, triangle.v3);
+                    }
+
+                    *current++ = '\n';
+                }
+
+                sizes[i] = current - buffer.data();
+            }
+        }, waveCount);
+
+        for (size_t i = 0; i < waveCount; i++)
+            file->write(buffers[i].data(), sizes[i]);
+
+        if (progress != nullptr) {
+            size_t last = (wave + waveCount) * WRITE_CHUNK_SIZE;
+
+            progress->advance((last < count ? last : count) - wave * WRITE_CHUNK_SIZE);
+
+            if (progress->isCancelled())
+                return;
+        }
+    }
+}
+
+void File::writeBinary(const Geometry * geometry) {
+    BinaryHeader header;
+    memset(&header, 0, sizeof(BinaryHeader));
+
+    vector<BinaryMesh> meshTable(geometry->getMeshCount());
+    string nameTable;
+
+    header.magic = BINARY_MAGIC;
+    header.version = BINARY_VERSION;
+    header.vertexCount = geometry->getVertexCount();
+    header.meshCount = geometry->getMeshCount();
+    header.meshTableOffset = sizeof(BinaryHeader);
+    header.nameTableOffset = header.meshTableOffset + header.meshCount * sizeof(BinaryMesh);
 
     for (size_t i = 0; i < geometry->getMeshCount(); i++) {
-        mesh = geometry->getMeshByIndex(i);
+        const Mesh * mesh = geometry->getMeshByIndex(i);
 
-        *file << "g " << mesh->name << endl;
+        memset(&meshTable[i], 0, sizeof(BinaryMesh));
 
-        for (size_t j = 0; j < mesh->triangles.size(); j++) {
-            triangle = mesh->triangles[j];
-            *file << "f " << triangle->v1 << " " << triangle->v2 << " " << triangle->v3 << endl;
+        meshTable[i].nameOffset = nameTable.size();
+        meshTable[i].nameLength = mesh->name.size();
+        meshTable[i].triangleCount = mesh->getTriangleCount();
+        meshTable[i].tetrahedronCount = mesh->volume.getTetrahedronCount();
+        meshTable[i].attributeCount = mesh->volume.attributeCount;
+
+        nameTable += mesh->name;
+    }
+
+    header.vertexOffset = align(header.nameTableOffset + nameTable.size());
+
+    uint64_t offset = align(header.vertexOffset + header.vertexCount * sizeof(Vector));
+
+    for (size_t i = 0; i < meshTable.size(); i++) {
+        BinaryMesh & binaryMesh = meshTable[i];
+
+        binaryMesh.triangleOffset = offset;
+        offset = align(offset + binaryMesh.triangleCount * 3 * sizeof(uint64_t));
+
+        binaryMesh.tetrahedronOffset = offset;
+        offset = align(offset + binaryMesh.tetrahedronCount * 4 * sizeof(uint64_t));
+
+        if (geometry->getMeshByIndex(i)->volume.hasNeighbors()) {
+            binaryMesh.neighborOffset = offset;
+            offset = align(offset + binaryMesh.tetrahedronCount * 4 * sizeof(uint64_t));
+        }
+
+        if (binaryMesh.attributeCount != 0) {
+            binaryMesh.attributeOffset = offset;
+            offset = align(offset + binaryMesh.tetrahedronCount * binaryMesh.attributeCount * sizeof(float));
+        }
+    }
+
+    file->write((const char *)&header, sizeof(BinaryHeader));
+
+    if (!meshTable.empty())
+        file->write((const char *)meshTable.data(), meshTable.size() * sizeof(BinaryMesh));
+
+    file->write(nameTable.data(), nameTable.size());
+
+    offset = header.nameTableOffset + nameTable.size();
+
+    writeBlock(offset, header.vertexOffset, geometry->getPointData(),
+        header.vertexCount * sizeof(Vector));
+
+    if (progress != nullptr)
+        progress->advance(geometry->getVertexCount());
+
+    vector<uint64_t> indices;
+
+    for (size_t i = 0; i < meshTable.size(); i++) {
+        const BinaryMesh & binaryMesh = meshTable[i];
+        const Mesh * mesh = geometry->getMeshByIndex(i);
+        const TetrahedralMesh & volume = mesh->volume;
+
+        writeIndices(offset, binaryMesh.triangleOffset, mesh->getIndexData(),
+            mesh->getTriangleCount() * 3, indices);
+        writeIndices(offset, binaryMesh.tetrahedronOffset, volume.getIndexData(),
+            volume.getTetrahedronCount() * 4, indices);
+
+        if (volume.hasNeighbors())
+            writeIndices(offset, binaryMesh.neighborOffset, volume.neighbors.data(),
+                volume.neighbors.size(), indices);
+
+        if (volume.hasAttributes())
+            writeBlock(offset, binaryMesh.attributeOffset, volume.attributes.data(),
+                volume.attributes.size() * sizeof(float));
+
+        if (progress != nullptr) {
+            progress->advance(mesh->getTriangleCount() + volume.getTetrahedronCount());
+
+            if (progress->isCancelled())
+                return;
         }
     }
 }
 
-VIRGO_NAMESPACE_END
+void File::writeBlock(uint64_t & offset, uint64_t blockOffset, const void * data, size_t size) {
+    static const char padding[BINARY_ALIGNMENT] = { 0 };
+
+    file->write(padding, (size_t)(blockOffset - offset));
+
+    if (size != 0)
+        file->write((const char *)data, size);
+
+    offset = blockOffset + size;
+}
+
+void File::writeIndices(uint64_t & offset, uint64_t blockOffset, const size_t * data, size_t count,
+    vector<uint64_t> & indices) {
+    if (sizeof(size_t) == sizeof(uint64_t) || count == 0) {
+        writeBlock(offset, blockOffset, data, count * sizeof(uint64_t));
+        return;
+    }
+
+    indices.assign(data, data + count);
+    writeBlock(offset, blockOffset, indices.data(), count * sizeof(uint64_t));
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,502 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "intersectionChecker.h"
+#include "boundingVolumeHierarchy.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+#define EPSILON 1.1102230246251565e-16
+#define ORIENTATION_2D_BOUND ((3.0 + 16.0 * EPSILON) * EPSILON)
+#define ORIENTATION_3D_BOUND ((7.0 + 56.0 * EPSILON) * EPSILON)
+
+VIRGO_NAMESPACE_BEGIN
+
+typedef Vec2<float> PlanePoint;
+
+static void twoSum(double a, double b, double & sum, double & error) {
+    sum = a + b;
+
+    double virtualB = sum - a;
+    double virtualA = sum - virtualB;
+
+    error = (a - virtualA) + (b - virtualB);
+}
+
+static void growExpansion(double * expansion, size_t & count, double value) {
+    for (size_t i = 0; i < count; i++)
+        twoSum(value, expansion[i], value, expansion[i]);
+
+    expansion[count++] = value;
+}
+
+static int getExpansionSign(const double * expansion, size_t count) {
+    for (size_t i = count; i > 0; i--) {
+        if (expansion[i - 1] != 0)
+            return expansion[i - 1] > 0 ? 1 : -1;
+    }
+
+    return 0;
+}
+
+static void addProduct(double * expansion, size_t & count, double sign, float a, float b, float c) {
+    double product = (double)a * b * sign;
+    double high = product * c;
+
+    growExpansion(expansion, count, fma(product, (double)c, -high));
+    growExpansion(expansion, count, high);
+}
+
+static void addDeterminant(double * expansion, size_t & count, double sign,
+    const Vector & a, const Vector & b, const Vector & c) {
+    addProduct(expansion, count, sign, a.x, b.y, c.z);
+    addProduct(expansion, count, -sign, a.x, b.z, c.y);
+    addProduct(expansion, count, -sign, a.y, b.x, c.z);
+    addProduct(expansion, count, sign, a.y, b.z, c.x);
+    addProduct(expansion, count, sign, a.z, b.x, c.y);
+    addProduct(expansion, count, -sign, a.z, b.y, c.x);
+}
+
+static int orient(const PlanePoint & a, const PlanePoint & b, const PlanePoint & c) {
+    double left = ((double)a.x - c.x) * ((double)b.y - c.y);
+    double right = ((double)a.y - c.y) * ((double)b.x - c.x);
+    double determinant = left - right;
+
+    if (fabs(determinant) > ORIENTATION_2D_BOUND * (fabs(left) + fabs(right)))
+        return determinant > 0 ? 1 : -1;
+
+    double expansion[6];
+    size_t count = 0;
+
+    growExpansion(expansion, count, (double)a.x * b.y);
+    growExpansion(expansion, count, -(double)a.y * b.x);
+    growExpansion(expansion, count, -(double)c.x * b.y);
+    growExpansion(expansion, count, (double)c.y * b.x);
+    growExpansion(expansion, count, -(double)a.x * c.y);
+    growExpansion(expansion, count, (double)a.y * c.x);
+
+    return getExpansionSign(expansion, count);
+}
+
+static int orient(const Vector & a, const Vector & b, const Vector & c, const Vector & d) {
+    double adx = (double)a.x - d.x, ady = (double)a.y - d.y, adz = (double)a.z - d.z;
+    double bdx = (double)b.x - d.x, bdy = (double)b.y - d.y, bdz = (double)b.z - d.z;
+    double cdx = (double)c.x - d.x, cdy = (double)c.y - d.y, cdz = (double)c.z - d.z;
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    double determinant = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+    double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * fabs(adz)
+        + (fabs(cdxady) + fabs(adxcdy)) * fabs(bdz)
+        + (fabs(adxbdy) + fabs(bdxady)) * fabs(cdz);
+
+    if (fabs(determinant) > ORIENTATION_3D_BOUND * permanent)
+        return determinant > 0 ? 1 : -1;
+
+    double expansion[48];
+    size_t count = 0;
+
+    addDeterminant(expansion, count, 1.0, a, b, c);
+    addDeterminant(expansion, count, -1.0, d, b, c);
+    addDeterminant(expansion, count, -1.0, a, d, c);
+    addDeterminant(expansion, count, -1.0, a, b, d);
+
+    return getExpansionSign(expansion, count);
+}
+
+static int getProjectionAxis(const Vector & a, const Vector & b, const Vector & c) {
+    Vector normal = (b - a).cross(c - a);
+
+    normal.x = fabs(normal.x);
+    normal.y = fabs(normal.y);
+    normal.z = fabs(normal.z);
+
+    return normal.x >= normal.y ? (normal.x >= normal.z ? 0 : 2) : (normal.y >= normal.z ? 1 : 2);
+}
+
+static PlanePoint project(const Vector & point, int axis) {
+    if (axis == 0)
+        return PlanePoint(point.y, point.z);
+
+    if (axis == 1)
+        return PlanePoint(point.z, point.x);
+
+    return PlanePoint(point.x, point.y);
+}
+
+static bool isDegenerate(const Vector & a, const Vector & b, const Vector & c) {
+    for (int axis = 0; axis < 3; axis++) {
+        if (orient(project(a, axis), project(b, axis), project(c, axis)) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+static bool contains(const PlanePoint & a, const PlanePoint & b, const PlanePoint & point) {
+    return min(a.x, b.x) <= point.x && point.x <= max(a.x, b.x)
+        && min(a.y, b.y) <= point.y && point.y <= max(a.y, b.y);
+}
+
+static bool intersectSegments(const PlanePoint & p, const PlanePoint & q,
+    const PlanePoint & r, const PlanePoint & s) {
+    int first = orient(r, s, p);
+    int second = orient(r, s, q);
+    int third = orient(p, q, r);
+    int fourth = orient(p, q, s);
+
+    if (first * second < 0 && third * fourth < 0)
+        return true;
+
+    return (first == 0 && contains(r, s, p)) || (second == 0 && contains(r, s, q))
+        || (third == 0 && contains(p, q, r)) || (fourth == 0 && contains(p, q, s));
+}
+
+static bool containsPoint(const PlanePoint & a, const PlanePoint & b, const PlanePoint & c,
+    const PlanePoint & point) {
+    int first = orient(a, b, point);
+    int second = orient(b, c, point);
+    int third = orient(c, a, point);
+
+    return (first >= 0 && second >= 0 && third >= 0) || (first <= 0 && second <= 0 && third <= 0);
+}
+
+static bool intersectCoplanarSegment(const Vector & p, const Vector & q,
+    const Vector & a, const Vector & b, const Vector & c) {
+    int axis = getProjectionAxis(a, b, c);
+
+    PlanePoint p2 = project(p, axis), q2 = project(q, axis);
+    PlanePoint a2 = project(a, axis), b2 = project(b, axis), c2 = project(c, axis);
+
+    return containsPoint(a2, b2, c2, p2) || containsPoint(a2, b2, c2, q2)
+        || intersectSegments(p2, q2, a2, b2) || intersectSegments(p2, q2, b2, c2)
+        || intersectSegments(p2, q2, c2, a2);
+}
+
+static bool intersectCoplanarTriangles(const Vector * first, const Vector * second) {
+    int axis = getProjectionAxis(first[0], first[1], first[2]);
+
+    PlanePoint a[3], b[3];
+
+    for (size_t i = 0; i < 3; i++) {
+        a[i] = project(first[i], axis);
+        b[i] = project(second[i], axis);
+    }
+
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            if (intersectSegments(a[i], a[(i + 1) % 3], b[j], b[(j + 1) % 3]))
+                return true;
+        }
+    }
+
+    return containsPoint(a[0], a[1], a[2], b[0]) || containsPoint(b[0], b[1], b[2], a[0]);
+}
+
+static bool intersectSegment(const Vector & p, const Vector & q,
+    const Vector & a, const Vector & b, const Vector & c) {
+    int first = orient(a, b, c, p);
+    int second = orient(a, b, c, q);
+
+    if (first * second > 0)
+        return false;
+
+    if (first == 0 && second == 0)
+        return intersectCoplanarSegment(p, q, a, b, c);
+
+    int u = orient(p, q, a, b);
+    int v = orient(p, q, b, c);
+    int w = orient(p, q, c, a);
+
+    return (u >= 0 && v >= 0 && w >= 0) || (u <= 0 && v <= 0 && w <= 0);
+}
+
+static bool isSeparated(const Vector * first, const Vector * second, bool & coplanar) {
+    int a = orient(first[0], first[1], first[2], second[0]);
+    int b = orient(first[0], first[1], first[2], second[1]);
+    int c = orient(first[0], first[1], first[2], second[2]);
+
+    coplanar = a == 0 && b == 0 && c == 0;
+
+    return (a > 0 && b > 0 && c > 0) || (a < 0 && b < 0 && c < 0);
+}
+
+static bool intersectTriangles(const Vector * first, const Vector * second) {
+    bool coplanar = false;
+
+    if (isSeparated(first, second, coplanar) || isSeparated(second, first, coplanar))
+        return false;
+
+    if (coplanar)
+        return intersectCoplanarTriangles(first, second);
+
+    for (size_t i = 0; i < 3; i++) {
+        if (intersectSegment(first[i], first[(i + 1) % 3], second[0], second[1], second[2])
+            || intersectSegment(second[i], second[(i + 1) % 3], first[0], first[1], first[2]))
+            return true;
+    }
+
+    return false;
+}
+
+static bool overlapEdges(const Vector & shared, const Vector & p, const Vector & q) {
+    if (!isDegenerate(shared, p, q))
+        return false;
+
+    double x = ((double)p.x - shared.x) * ((double)q.x - shared.x);
+    double y = ((double)p.y - shared.y) * ((double)q.y - shared.y);
+    double z = ((double)p.z - shared.z) * ((double)q.z - shared.z);
+
+    return x + y + z > 0;
+}
+
+static bool intersectAdjacentTriangles(const Triangle & firstTriangle, const Triangle & secondTriangle,
+    const Vector * points) {
+    size_t first[3] = { firstTriangle.v1, firstTriangle.v2, firstTriangle.v3 };
+    size_t second[3] = { secondTriangle.v1, secondTriangle.v2, secondTriangle.v3 };
+
+    Vector a[3], b[3];
+
+    for (size_t i = 0; i < 3; i++) {
+        a[i] = points[first[i] - 1];
+        b[i] = points[second[i] - 1];
+    }
+
+    size_t firstShared[3], secondShared[3];
+    size_t sharedCount = 0;
+
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            if (first[i] == second[j] || a[i] == b[j]) {
+                firstShared[sharedCount] = i;
+                secondShared[sharedCount] = j;
+                sharedCount++;
+            }
+        }
+    }
+
+    if (sharedCount == 0)
+        return intersectTriangles(a, b);
+
+    if (sharedCount == 3)
+        return true;
+
+    if (sharedCount == 2) {
+        const Vector & p = a[3 - firstShared[0] - firstShared[1]];
+        const Vector & q = b[3 - secondShared[0] - secondShared[1]];
+
+        const Vector & s = a[firstShared[0]];
+        const Vector & t = a[firstShared[1]];
+
+        if (orient(s, t, p, q) != 0)
+            return false;
+
+        int axis = getProjectionAxis(s, t, p);
+
+        return orient(project(s, axis), project(t, axis), project(p, axis))
+            * orient(project(s, axis), project(t, axis), project(q, axis)) > 0;
+    }
+
+    size_t i = firstShared[0];
+    size_t j = secondShared[0];
+
+    for (size_t k = 1; k < 3; k++) {
+        for (size_t l = 1; l < 3; l++) {
+            if (overlapEdges(a[i], a[(i + k) % 3], b[(j + l) % 3]))
+                return true;
+        }
+    }
+
+    return intersectSegment(a[(i + 1) % 3], a[(i + 2) % 3], b[0], b[1], b[2])
+        || intersectSegment(b[(j + 1) % 3], b[(j + 2) % 3], a[0], a[1], a[2]);
+}
+
+static bool overlaps(const BoundingVolumeNode & node, const BoundingBox & box) {
+    return node.minimum.x <= box.max.x && node.maximum.x >= box.min.x
+        && node.minimum.y <= box.max.y && node.maximum.y >= box.min.y
+        && node.minimum.z <= box.max.z && node.maximum.z >= box.min.z;
+}
+
+Intersection::Intersection(size_t first, size_t second) : first(first), second(second) {}
+
+IntersectionChecker::IntersectionChecker() {
+    threadCount = 0;
+    maximumCount = 0;
+}
+
+IntersectionChecker::~IntersectionChecker() {}
+
+void IntersectionChecker::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+}
+
+size_t IntersectionChecker::getThreadCount() const {
+    return threadCount;
+}
+
+void IntersectionChecker::setMaximumCount(size_t maximumCount) {
+    this->maximumCount = maximumCount;
+}
+
+size_t IntersectionChecker::getMaximumCount() const {
+    return maximumCount;
+}
+
+bool IntersectionChecker::checkMesh(const Geometry * geometry, size_t index) {
+    clear();
+
+    if (geometry == nullptr || index >= geometry->getMeshCount())
+        return true;
+
+    size_t workerCount = threadCount != 0 ? threadCount : virgo::getThreadCount();
+
+    BoundingVolumeHierarchy hierarchy;
+    hierarchy.setThreadCount(workerCount);
+    hierarchy.build(geometry, index);
+
+    const Triangle * triangles = geometry->getMeshByIndex(index)->getTriangleData();
+    const Vector * points = geometry->getPointData();
+
+    const BoundingVolumeNode * nodes = hierarchy.getNodeData();
+    const Primitive * primitives = hierarchy.getPrimitiveData();
+
+    size_t count = hierarchy.getPrimitiveCount();
+    size_t stackSize = hierarchy.getDepth() + 1;
+
+    vector<char> degenerate(count);
+
+    parallelFor(count, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            const Triangle & triangle = triangles[primitives[i].triangle];
+
+            degenerate[i] = isDegenerate(points[triangle.v1 - 1], points[triangle.v2 - 1],
+                points[triangle.v3 - 1]);
+        }
+    }, workerCount);
+
+    atomic<size_t> found(0);
+    mutex lock;
+
+    parallelFor(count, [&](size_t first, size_t last) {
+        vector<Intersection> local;
+        vector<uint32_t> stack(stackSize);
+
+        Vector a, b, c;
+
+        for (size_t i = first; i < last; i++) {
+            if (maximumCount != 0 && found >= maximumCount)
+                break;
+
+            if (degenerate[i])
+                continue;
+
+            const Triangle & triangle = triangles[primitives[i].triangle];
+
+            hierarchy.getTriangle(primitives[i], a, b, c);
+
+            BoundingBox bounds(a);
+            bounds.extendBy(b);
+            bounds.extendBy(c);
+
+            size_t size = 0;
+            stack[size++] = 0;
+
+            while (size != 0) {
+                const BoundingVolumeNode & node = nodes[stack[--size]];
+
+                if (!overlaps(node, bounds))
+                    continue;
+
+                if (!node.isLeaf()) {
+                    stack[size++] = node.offset + 1;
+                    stack[size++] = node.offset;
+
+                    continue;
+                }
+
+                for (size_t j = max<size_t>(node.offset, i + 1); j < node.offset + node.count; j++) {
+                    if (degenerate[j])
+                        continue;
+
+                    const Triangle & other = triangles[primitives[j].triangle];
+
+                    if (!intersectAdjacentTriangles(triangle, other, points))
+                        continue;
+
+                    local.push_back(Intersection(min(primitives[i].triangle, primitives[j].triangle),
+                        max(primitives[i].triangle, primitives[j].triangle)));
+
+                    found++;
+                }
+            }
+        }
+
+        lock_guard<mutex> guard(lock);
+        intersections.insert(intersections.end(), local.begin(), local.end());
+    }, workerCount);
+
+    sort(intersections.begin(), intersections.end(),
+        [](const Intersection & first, const Intersection & second) {
+        return first.first != second.first ? first.first < second.first : first.second < second.second;
+    });
+
+    if (maximumCount != 0 && intersections.size() > maximumCount)
+        intersections.resize(maximumCount);
+
+    return intersections.empty();
+}
+
+void IntersectionChecker::clear() {
+    intersections.clear();
+}
+
+const vector<Intersection> & IntersectionChecker::getIntersections() const {
+    return intersections;
+}
+
+size_t IntersectionChecker::getIntersectionCount() const {
+    return intersections.size();
+}
+
+void IntersectionChecker::getFaces(vector<size_t> & faces) const {
+    faces.clear();
+
+    for (size_t i = 0; i < intersections.size(); i++) {
+        faces.push_back(intersections[i].first);
+        faces.push_back(intersections[i].second);
+    }
+
+    sort(faces.begin(), faces.end());
+    faces.erase(unique(faces.begin(), faces.end()), faces.end());
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
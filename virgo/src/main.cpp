@@ -26,10 +26,140 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "virgo.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 USE_VIRGO_NAMESPACE
 
+static int benchmark(int argc, char ** argv) {
+    BenchmarkSettings settings;
+    const char * filename = nullptr;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+
+        if (strcmp(argv[i], "--frames") == 0 && hasValue)
+            settings.frameCount = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+            settings.warmupCount = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--size") == 0 && hasValue)
+            sscanf(argv[++i], "%dx%d", &settings.width, &settings.height);
+        else if (strcmp(argv[i], "--images") == 0 && hasValue)
+            settings.imagePrefix = argv[++i];
+        else if (strcmp(argv[i], "--path") == 0 && hasValue) {
+            if (!settings.loadCameraPath(argv[++i])) {
+                fprintf(stderr, "Invalid camera path: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (filename == nullptr)
+            filename = argv[i];
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (filename == nullptr) {
+        fprintf(stderr, "Usage: virgo --benchmark <file> [--frames N] [--warmup N] "
+            "[--size WxH] [--path file] [--images prefix]\n");
+        return 1;
+    }
+
+    Geometry * geometry = new Geometry;
+    File file;
+
+    file.open(filename, FileMode::Read);
+
+    if (!file.isOpen()) {
+        fprintf(stderr, "Unable to open file: %s\n", filename);
+        delete geometry;
+        return 1;
+    }
+
+    bool valid = file.read(geometry);
+    file.close();
+
+    if (!valid) {
+        fprintf(stderr, "Invalid or unsupported file: %s\n", filename);
+        delete geometry;
+        return 1;
+    }
+
+    Viewport viewport;
+    FrameStatistics statistics;
+
+    viewport.loadGeometry(geometry);
+
+    bool status = viewport.benchmark(settings, statistics);
+
+    delete geometry;
+
+    if (statistics.frameCount == 0) {
+        fprintf(stderr, "Unable to create an offscreen context.\n");
+        return 1;
+    }
+
+    printf("Frames: %zu at %dx%d\n", statistics.frameCount, settings.width, settings.height);
+    printf("Triangles per frame: %zu\n", statistics.triangleCount);
+    printf("Vertex cache miss ratio: %.3f, unoptimized %.3f\n", statistics.cacheMissRatio,
+        statistics.initialCacheMissRatio);
+    printf("Frame time (ms): min %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n",
+        statistics.minimumTime * 1000.0, statistics.medianTime * 1000.0,
+        statistics.percentile90Time * 1000.0, statistics.percentile99Time * 1000.0,
+        statistics.maximumTime * 1000.0);
+    printf("Frame rate: %.2f fps\n", statistics.getFrameRate());
+    printf("Triangle rate: %.2f M/s\n", statistics.getTriangleRate() / 1000000.0);
+
+    return status ? 0 : 1;
+}
+
+static int service(int argc, char ** argv) {
+    Service service;
+
+    for (int i = 2; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+
+        if (strcmp(argv[i], "--workers") == 0 && hasValue)
+            service.setWorkerCount(strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--memory") == 0 && hasValue)
+            service.setMemoryLimit(strtoul(argv[++i], nullptr, 10) << 20);
+        else if (strcmp(argv[i], "--poll") == 0 && hasValue)
+            service.setPollInterval(strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--once") == 0)
+            service.setSingleRun(true);
+        else if (i == 2)
+            service.setDirectory(argv[i]);
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            fprintf(stderr, "Usage: virgo --service <directory> [--workers N] [--memory MB] "
+                "[--poll ms] [--once]\n");
+            return 1;
+        }
+    }
+
+    return service.run();
+}
+
 int main(int argc, char ** argv) {
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+        return benchmark(argc, argv);
+
+    if (argc > 1 && strcmp(argv[1], "--service") == 0)
+        return service(argc, argv);
+
+    if (Batch::isBatch(argc, argv)) {
+        Batch batch;
+
+        if (!batch.parse(argc, argv)) {
+            Batch::printUsage();
+            return 1;
+        }
+
+        return batch.run();
+    }
+
     Application application;
     application.show();
 
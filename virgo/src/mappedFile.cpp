@@ -0,0 +1,167 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+VIRGO_NAMESPACE_BEGIN
+
+MappedFile::MappedFile() {
+    data = nullptr;
+    size = 0;
+
+    status = false;
+
+#ifdef _WIN32
+    handle = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+#else
+    handle = -1;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::open(const char * filename) {
+    close();
+
+#ifdef _WIN32
+    handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (handle == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(handle, &fileSize)) {
+        close();
+        return;
+    }
+
+    size = (size_t)fileSize.QuadPart;
+
+    if (size != 0) {
+        mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping == nullptr) {
+            close();
+            return;
+        }
+
+        data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+        if (data == nullptr) {
+            close();
+            return;
+        }
+    }
+#else
+    handle = ::open(filename, O_RDONLY);
+
+    if (handle == -1)
+        return;
+
+    struct stat fileStatus;
+
+    if (fstat(handle, &fileStatus) != 0) {
+        close();
+        return;
+    }
+
+    size = (size_t)fileStatus.st_size;
+
+    if (size != 0) {
+        void * address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, handle, 0);
+
+        if (address == MAP_FAILED) {
+            close();
+            return;
+        }
+
+        madvise(address, size, MADV_SEQUENTIAL);
+        data = (const char *)address;
+    }
+#endif
+
+    status = true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (data != nullptr)
+        UnmapViewOfFile(data);
+
+    if (mapping != nullptr)
+        CloseHandle(mapping);
+
+    if (handle != INVALID_HANDLE_VALUE)
+        CloseHandle(handle);
+
+    handle = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+#else
+    if (data != nullptr)
+        munmap((void *)data, size);
+
+    if (handle != -1)
+        ::close(handle);
+
+    handle = -1;
+#endif
+
+    data = nullptr;
+    size = 0;
+
+    status = false;
+}
+
+bool MappedFile::isOpen() const {
+    return status;
+}
+
+const char * MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
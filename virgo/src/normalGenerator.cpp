@@ -0,0 +1,316 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "normalGenerator.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#define DEFAULT_CREASE_ANGLE 60.0f
+#define PI 3.14159265358979323846
+
+VIRGO_NAMESPACE_BEGIN
+
+static size_t findRoot(vector<size_t> & parents, size_t index) {
+    while (parents[index] != index) {
+        parents[index] = parents[parents[index]];
+        index = parents[index];
+    }
+
+    return index;
+}
+
+static float getCornerAngle(const Vector & corner, const Vector & next, const Vector & previous) {
+    Vector first = next - corner;
+    Vector second = previous - corner;
+
+    return atan2(first.cross(second).length(), first.dot(second));
+}
+
+NormalGenerator::NormalGenerator() {
+    weighting = NormalWeighting::AngleWeighting;
+    creaseAngle = DEFAULT_CREASE_ANGLE;
+    threadCount = 0;
+
+    generatedCount = 0;
+}
+
+NormalGenerator::~NormalGenerator() {}
+
+void NormalGenerator::setWeighting(const NormalWeighting & weighting) {
+    this->weighting = weighting;
+}
+
+NormalWeighting NormalGenerator::getWeighting() const {
+    return weighting;
+}
+
+void NormalGenerator::setCreaseAngle(float creaseAngle) {
+    this->creaseAngle = min(max(creaseAngle, 0.0f), 180.0f);
+}
+
+float NormalGenerator::getCreaseAngle() const {
+    return creaseAngle;
+}
+
+void NormalGenerator::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+}
+
+size_t NormalGenerator::getThreadCount() const {
+    return threadCount;
+}
+
+void NormalGenerator::generateMesh(Geometry * geometry, size_t index) {
+    generatedCount = 0;
+
+    Mesh * mesh = geometry->getMeshByIndex(index);
+
+    if (mesh != nullptr && !mesh->normals.isValid(mesh->getTriangleCount(), weighting, creaseAngle))
+        generateNormals(geometry, mesh);
+}
+
+void NormalGenerator::generateAll(Geometry * geometry) {
+    size_t count = 0;
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
+        generateMesh(geometry, i);
+        count += generatedCount;
+    }
+
+    generatedCount = count;
+}
+
+size_t NormalGenerator::getGeneratedCount() const {
+    return generatedCount;
+}
+
+void NormalGenerator::generateNormals(const Geometry * geometry, Mesh * mesh) {
+    size_t workerCount = threadCount != 0 ? threadCount : virgo::getThreadCount();
+    size_t triangleCount = mesh->getTriangleCount();
+    size_t cornerCount = triangleCount * 3;
+
+    const Vector * points = geometry->getPointData();
+    const size_t * vertices = mesh->getIndexData();
+
+    if (locals.size() < geometry->getVertexCount())
+        locals.resize(geometry->getVertexCount(), SIZE_MAX);
+
+    vector<size_t> corners(cornerCount);
+    vector<size_t> owners;
+
+    for (size_t i = 0; i < cornerCount; i++) {
+        size_t & local = locals[vertices[i] - 1];
+
+        if (local == SIZE_MAX) {
+            local = owners.size();
+            owners.push_back(vertices[i] - 1);
+        }
+
+        corners[i] = local;
+    }
+
+    size_t vertexCount = owners.size();
+
+    for (size_t i = 0; i < vertexCount; i++)
+        locals[owners[i]] = SIZE_MAX;
+
+    vector<size_t> offsets(vertexCount + 1, 0);
+    vector<size_t> incidences(cornerCount);
+
+    for (size_t i = 0; i < cornerCount; i++)
+        offsets[corners[i] + 1]++;
+
+    for (size_t i = 1; i <= vertexCount; i++)
+        offsets[i] += offsets[i - 1];
+
+    for (size_t i = 0; i < cornerCount; i++)
+        incidences[offsets[corners[i]]++] = i;
+
+    for (size_t i = vertexCount; i > 0; i--)
+        offsets[i] = offsets[i - 1];
+
+    offsets[0] = 0;
+
+    vector<Vector> faceNormals(triangleCount);
+    vector<Vector> weights(cornerCount);
+
+    bool angleWeighting = weighting == NormalWeighting::AngleWeighting;
+
+    parallelFor(triangleCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            const Vector & a = points[vertices[i * 3] - 1];
+            const Vector & b = points[vertices[i * 3 + 1] - 1];
+            const Vector & c = points[vertices[i * 3 + 2] - 1];
+
+            Vector normal = (b - a).cross(c - a);
+            faceNormals[i] = normal.normalized();
+
+            if (angleWeighting) {
+                weights[i * 3] = faceNormals[i] * getCornerAngle(a, b, c);
+                weights[i * 3 + 1] = faceNormals[i] * getCornerAngle(b, c, a);
+                weights[i * 3 + 2] = faceNormals[i] * getCornerAngle(c, a, b);
+            }
+            else {
+                weights[i * 3] = normal;
+                weights[i * 3 + 1] = normal;
+                weights[i * 3 + 2] = normal;
+            }
+        }
+    }, workerCount);
+
+    float threshold = (float)cos(creaseAngle * PI / 180.0);
+    bool smooth = creaseAngle >= 180.0f;
+
+    vector<Vector> cornerNormals(cornerCount);
+    vector<size_t> slots(cornerCount);
+    vector<size_t> counts(vertexCount + 1, 0);
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        vector<pair<size_t, size_t> > edges;
+        vector<size_t> parents, groups;
+        vector<Vector> sums;
+
+        for (size_t i = first; i < last; i++) {
+            size_t begin = offsets[i];
+            size_t end = offsets[i + 1];
+
+            if (smooth) {
+                Vector normal(0, 0, 0);
+
+                for (size_t j = begin; j < end; j++)
+                    normal += weights[incidences[j]];
+
+                cornerNormals[incidences[begin]] = normal.normalized();
+
+                for (size_t j = begin; j < end; j++)
+                    slots[incidences[j]] = 0;
+
+                counts[i + 1] = 1;
+
+                continue;
+            }
+
+            size_t valence = end - begin;
+
+            edges.clear();
+            parents.resize(valence);
+
+            for (size_t j = 0; j < valence; j++) {
+                size_t corner = incidences[begin + j];
+                size_t base = corner - corner % 3;
+
+                edges.push_back(make_pair(corners[base + (corner % 3 + 1) % 3], j));
+                edges.push_back(make_pair(corners[base + (corner % 3 + 2) % 3], j));
+
+                parents[j] = j;
+            }
+
+            sort(edges.begin(), edges.end());
+
+            for (size_t j = 1; j < edges.size(); j++) {
+                if (edges[j].first != edges[j - 1].first)
+                    continue;
+
+                size_t left = edges[j - 1].second;
+                size_t right = edges[j].second;
+
+                if (faceNormals[incidences[begin + left] / 3].dot(
+                    faceNormals[incidences[begin + right] / 3]) < threshold)
+                    continue;
+
+                left = findRoot(parents, left);
+                right = findRoot(parents, right);
+
+                if (left != right)
+                    parents[max(left, right)] = min(left, right);
+            }
+
+            size_t count = 0;
+
+            groups.resize(valence);
+            sums.resize(valence);
+
+            for (size_t j = 0; j < valence; j++) {
+                size_t root = findRoot(parents, j);
+
+                if (root == j) {
+                    groups[j] = count++;
+                    sums[groups[j]] = Vector(0, 0, 0);
+                }
+
+                sums[groups[root]] += weights[incidences[begin + j]];
+            }
+
+            for (size_t j = 0; j < count; j++)
+                sums[j] = sums[j].normalized();
+
+            for (size_t j = 0; j < valence; j++) {
+                size_t corner = incidences[begin + j];
+                size_t slot = groups[findRoot(parents, j)];
+
+                cornerNormals[corner] = sums[slot];
+                slots[corner] = slot;
+            }
+
+            counts[i + 1] = count;
+        }
+    }, workerCount);
+
+    for (size_t i = 1; i <= vertexCount; i++)
+        counts[i] += counts[i - 1];
+
+    SurfaceNormals & normals = mesh->normals;
+
+    normals.normals.resize(counts[vertexCount]);
+    normals.indices.resize(cornerCount);
+
+    Vector * normalData = normals.normals.data();
+    size_t * indexData = normals.indices.data();
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            for (size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+                size_t corner = incidences[j];
+                size_t index = counts[i] + slots[corner];
+
+                if (!smooth || j == offsets[i])
+                    normalData[index] = cornerNormals[corner];
+
+                indexData[corner] = index;
+            }
+        }
+    }, workerCount);
+
+    normals.weighting = weighting;
+    normals.creaseAngle = creaseAngle;
+
+    generatedCount = 1;
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,320 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "numeric.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#define ROUNDING_TOLERANCE 1e-5
+
+VIRGO_NAMESPACE_BEGIN
+
+using namespace std;
+
+static const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static double scale(double value, int exponent) {
+    if (exponent < 0) {
+        if (exponent >= -22)
+            return value / powersOfTen[-exponent];
+
+        return value * pow(10.0, exponent);
+    }
+
+    if (exponent > 0) {
+        if (exponent <= 22)
+            return value * powersOfTen[exponent];
+
+        return value * pow(10.0, exponent);
+    }
+
+    return value;
+}
+
+static bool isDigit(char character) {
+    return (unsigned char)(character - '0') < 10;
+}
+
+static bool matchWord(const char * begin, const char * end, const char * word) {
+    for (; *word != '\0'; begin++, word++) {
+        if (begin == end || (*begin | 0x20) != *word)
+            return false;
+    }
+
+    return true;
+}
+
+const char * parseFloat(const char * begin, const char * end, float & value) {
+    const char * current = begin;
+    bool negative = false;
+
+    if (current != end && (*current == '-' || *current == '+')) {
+        negative = (*current == '-');
+        current++;
+    }
+
+    if (current != end && !isDigit(*current) && *current != '.') {
+        if (matchWord(current, end, "inf")) {
+            value = negative ? -numeric_limits<float>::infinity() : numeric_limits<float>::infinity();
+            current += matchWord(current, end, "infinity") ? 8 : 3;
+
+            return current;
+        }
+
+        if (matchWord(current, end, "nan")) {
+            value = numeric_limits<float>::quiet_NaN();
+            return current + 3;
+        }
+
+        return begin;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digitCount = 0;
+    bool hasDigits = false;
+
+    for (; current != end && isDigit(*current); current++) {
+        hasDigits = true;
+
+        if (digitCount < 19) {
+            mantissa = mantissa * 10 + (*current - '0');
+
+            if (mantissa != 0)
+                digitCount++;
+        }
+        else {
+            exponent++;
+        }
+    }
+
+    if (current != end && *current == '.') {
+        current++;
+
+        for (; current != end && isDigit(*current); current++) {
+            hasDigits = true;
+
+            if (digitCount < 19) {
+                mantissa = mantissa * 10 + (*current - '0');
+                exponent--;
+
+                if (mantissa != 0)
+                    digitCount++;
+            }
+        }
+    }
+
+    if (!hasDigits)
+        return begin;
+
+    if (current != end && (*current == 'e' || *current == 'E')) {
+        const char * exponentBegin = current + 1;
+        bool negativeExponent = false;
+        int exponentValue = 0;
+
+        if (exponentBegin != end && (*exponentBegin == '-' || *exponentBegin == '+')) {
+            negativeExponent = (*exponentBegin == '-');
+            exponentBegin++;
+        }
+
+        if (exponentBegin != end && isDigit(*exponentBegin)) {
+            for (current = exponentBegin; current != end && isDigit(*current); current++) {
+                if (exponentValue < 10000)
+                    exponentValue = exponentValue * 10 + (*current - '0');
+            }
+
+            exponent += negativeExponent ? -exponentValue : exponentValue;
+        }
+    }
+
+    double result = mantissa != 0 ? scale((double)mantissa, exponent) : 0;
+
+    value = (float)(negative ? -result : result);
+
+    return current;
+}
+
+const char * parseUInt(const char * begin, const char * end, size_t & value) {
+    const char * current = begin;
+    size_t result = 0;
+
+    if (current != end && *current == '+')
+        current++;
+
+    if (current == end || !isDigit(*current))
+        return begin;
+
+    for (; current != end && isDigit(*current); current++)
+        result = result * 10 + (*current - '0');
+
+    value = result;
+
+    return current;
+}
+
+char * formatFloat(char * buffer, float value, int precision) {
+    if (signbit(value)) {
+        *buffer++ = '-';
+        value = -value;
+    }
+
+    if (value != value) {
+        memcpy(buffer, "nan", 3);
+        return buffer + 3;
+    }
+
+    if (value == numeric_limits<float>::infinity()) {
+        memcpy(buffer, "inf", 3);
+        return buffer + 3;
+    }
+
+    if (value == 0) {
+        *buffer++ = '0';
+        return buffer;
+    }
+
+    if (precision <= 0 || precision > 9)
+        precision = precision <= 0 ? 0 : 9;
+
+    double number = value;
+    int exponent = (int)floor(log10(number));
+
+    uint64_t mantissa = 0;
+    int digitCount = precision != 0 ? precision : 1;
+
+    for (; digitCount <= 9; digitCount++) {
+        mantissa = (uint64_t)floor(scale(number, digitCount - 1 - exponent) + 0.5);
+
+        if (mantissa >= (uint64_t)powersOfTen[digitCount]) {
+            mantissa = (uint64_t)floor(scale(number, digitCount - 2 - exponent) + 0.5);
+            exponent++;
+        }
+        else if (mantissa < (uint64_t)powersOfTen[digitCount - 1]) {
+            mantissa = (uint64_t)floor(scale(number, digitCount - exponent) + 0.5);
+            exponent--;
+        }
+
+        if (precision != 0 || (float)scale((double)mantissa, exponent + 1 - digitCount) == value)
+            break;
+    }
+
+    if (digitCount > 9)
+        digitCount = 9;
+
+    if (precision != 0) {
+        double scaled = scale(number, digitCount - 1 - exponent);
+
+        if (fabs(scaled - floor(scaled) - 0.5) < ROUNDING_TOLERANCE) {
+            char text[32];
+            int length = snprintf(text, sizeof(text), "%.*g", precision, number);
+
+            memcpy(buffer, text, length);
+
+            return buffer + length;
+        }
+    }
+
+    while (digitCount > 1 && mantissa % 10 == 0) {
+        mantissa /= 10;
+        digitCount--;
+    }
+
+    char digits[10];
+
+    for (int i = digitCount - 1; i >= 0; i--, mantissa /= 10)
+        digits[i] = (char)('0' + mantissa % 10);
+
+    int notationLimit = precision != 0 ? precision : 9;
+
+    if (exponent >= 0 && exponent < notationLimit) {
+        for (int i = 0; i <= exponent; i++)
+            *buffer++ = i < digitCount ? digits[i] : '0';
+
+        if (digitCount > exponent + 1) {
+            *buffer++ = '.';
+
+            for (int i = exponent + 1; i < digitCount; i++)
+                *buffer++ = digits[i];
+        }
+    }
+    else if (exponent < 0 && exponent >= -4) {
+        *buffer++ = '0';
+        *buffer++ = '.';
+
+        for (int i = -1; i > exponent; i--)
+            *buffer++ = '0';
+
+        for (int i = 0; i < digitCount; i++)
+            *buffer++ = digits[i];
+    }
+    else {
+        *buffer++ = digits[0];
+
+        if (digitCount > 1) {
+            *buffer++ = '.';
+
+            for (int i = 1; i < digitCount; i++)
+                *buffer++ = digits[i];
+        }
+
+        *buffer++ = 'e';
+        *buffer++ = exponent < 0 ? '-' : '+';
+
+        if (exponent < 0)
+            exponent = -exponent;
+
+        if (exponent < 10)
+            *buffer++ = '0';
+
+        buffer = formatUInt(buffer, (size_t)exponent);
+    }
+
+    return buffer;
+}
+
+char * formatUInt(char * buffer, size_t value) {
+    char digits[20];
+    size_t digitCount = 0;
+
+    do {
+        digits[digitCount++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (digitCount != 0)
+        *buffer++ = digits[--digitCount];
+
+    return buffer;
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,176 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "offscreenContext.h"
+
+#ifdef _WIN32
+#include <GL\freeglut.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#endif
+
+VIRGO_NAMESPACE_BEGIN
+
+OffscreenContext::OffscreenContext() {
+#ifdef _WIN32
+    window = -1;
+#else
+    display = nullptr;
+    surface = nullptr;
+    context = nullptr;
+#endif
+
+    status = false;
+}
+
+OffscreenContext::~OffscreenContext() {
+    destroy();
+}
+
+bool OffscreenContext::create(int width, int height) {
+    destroy();
+
+#ifdef _WIN32
+    int argc = 0;
+
+    if (!glutGet(GLUT_INIT_STATE))
+        glutInit(&argc, nullptr);
+
+    glutInitDisplayMode(GLUT_RGBA | GLUT_DEPTH | GLUT_DOUBLE);
+    glutInitWindowSize(width, height);
+
+    window = glutCreateWindow("Viewport");
+    glutHideWindow();
+
+    status = window > 0;
+#else
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (getPlatformDisplay != nullptr) {
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+        if (eglDisplay != EGL_NO_DISPLAY && !eglInitialize(eglDisplay, nullptr, nullptr))
+            eglDisplay = EGL_NO_DISPLAY;
+    }
+
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+        if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr))
+            return false;
+    }
+
+    display = eglDisplay;
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+
+    const EGLint surfaceAttributes[] = {
+        EGL_WIDTH, width,
+        EGL_HEIGHT, height,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configCount = 0;
+
+    if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount)
+        || configCount == 0 || !eglBindAPI(EGL_OPENGL_API)) {
+        destroy();
+        return false;
+    }
+
+    surface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttributes);
+    context = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, nullptr);
+
+    if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT
+        || !eglMakeCurrent(eglDisplay, surface, surface, context)) {
+        destroy();
+        return false;
+    }
+
+    status = true;
+#endif
+
+    return status;
+}
+
+void OffscreenContext::destroy() {
+#ifdef _WIN32
+    if (window > 0)
+        glutDestroyWindow(window);
+
+    window = -1;
+#else
+    if (display != nullptr) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        if (context != nullptr)
+            eglDestroyContext(display, context);
+
+        if (surface != nullptr)
+            eglDestroySurface(display, surface);
+
+        eglTerminate(display);
+    }
+
+    display = nullptr;
+    surface = nullptr;
+    context = nullptr;
+#endif
+
+    status = false;
+}
+
+bool OffscreenContext::isValid() const {
+    return status;
+}
+
+RendererProcedure OffscreenContext::getProcedure(const char * name) {
+#ifdef _WIN32
+    return (RendererProcedure)glutGetProcAddress(name);
+#else
+    return (RendererProcedure)eglGetProcAddress(name);
+#endif
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
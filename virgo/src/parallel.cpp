@@ -0,0 +1,89 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "parallel.h"
+#include <exception>
+#include <thread>
+#include <vector>
+
+VIRGO_NAMESPACE_BEGIN
+
+size_t getThreadCount() {
+    size_t threadCount = thread::hardware_concurrency();
+    return threadCount != 0 ? threadCount : 1;
+}
+
+void parallelFor(size_t count, const function<void(size_t, size_t)> & body,
+    size_t threadCount) {
+    if (count == 0)
+        return;
+
+    if (threadCount == 0)
+        threadCount = getThreadCount();
+
+    if (threadCount > count)
+        threadCount = count;
+
+    if (threadCount == 1) {
+        body(0, count);
+        return;
+    }
+
+    vector<thread> threads;
+    vector<exception_ptr> exceptions(threadCount);
+
+    threads.reserve(threadCount - 1);
+
+    for (size_t i = 0; i < threadCount; i++) {
+        size_t begin = count * i / threadCount;
+        size_t end = count * (i + 1) / threadCount;
+
+        auto task = [&body, &exceptions, i, begin, end]() {
+            try {
+                body(begin, end);
+            }
+            catch (...) {
+                exceptions[i] = current_exception();
+            }
+        };
+
+        if (i + 1 < threadCount)
+            threads.push_back(thread(task));
+        else
+            task();
+    }
+
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    for (size_t i = 0; i < exceptions.size(); i++) {
+        if (exceptions[i] != nullptr)
+            rethrow_exception(exceptions[i]);
+    }
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
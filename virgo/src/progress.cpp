@@ -0,0 +1,88 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "progress.h"
+
+VIRGO_NAMESPACE_BEGIN
+
+Progress::Progress() {
+    reset();
+}
+
+Progress::~Progress() {}
+
+void Progress::reset() {
+    phase = ProgressPhase::IdlePhase;
+    total = 0;
+    completed = 0;
+    cancelled = false;
+}
+
+void Progress::setPhase(const ProgressPhase & phase) {
+    this->phase = phase;
+}
+
+ProgressPhase Progress::getPhase() const {
+    return (ProgressPhase)phase.load();
+}
+
+void Progress::setTotal(size_t total) {
+    this->total = total;
+    completed = 0;
+}
+
+size_t Progress::getTotal() const {
+    return total;
+}
+
+void Progress::advance(size_t count) {
+    completed += count;
+}
+
+size_t Progress::getCompleted() const {
+    return completed;
+}
+
+double Progress::getFraction() const {
+    size_t total = this->total;
+    size_t completed = this->completed;
+
+    if (total == 0)
+        return 0;
+
+    return completed < total ? (double)completed / total : 1.0;
+}
+
+void Progress::cancel() {
+    cancelled = true;
+}
+
+bool Progress::isCancelled() const {
+    return cancelled;
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,410 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "renderer.h"
+#include <cstddef>
+#include <algorithm>
+#include <GL\freeglut.h>
+#include <GL\GL.h>
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STATIC_DRAW 0x88E4
+#endif
+
+VIRGO_NAMESPACE_BEGIN
+
+typedef void (APIENTRY * GenBuffersProcedure)(GLsizei, GLuint *);
+typedef void (APIENTRY * DeleteBuffersProcedure)(GLsizei, const GLuint *);
+typedef void (APIENTRY * BindBufferProcedure)(GLenum, GLuint);
+typedef void (APIENTRY * BufferDataProcedure)(GLenum, ptrdiff_t, const void *, GLenum);
+typedef void (APIENTRY * GetBufferSubDataProcedure)(GLenum, ptrdiff_t, ptrdiff_t, void *);
+
+static GenBuffersProcedure genBuffers = nullptr;
+static DeleteBuffersProcedure deleteBuffers = nullptr;
+static BindBufferProcedure bindBuffer = nullptr;
+static BufferDataProcedure bufferData = nullptr;
+static GetBufferSubDataProcedure getBufferSubData = nullptr;
+
+Renderer::Renderer() {
+    bufferSupport = false;
+    cacheOptimization = true;
+
+    loadedGeometry = nullptr;
+    loadedVersion = 0;
+    updatedMeshCount = 0;
+}
+
+Renderer::~Renderer() {
+    clear();
+}
+
+void Renderer::initialize(RendererLoader loader) {
+    release();
+
+    genBuffers = (GenBuffersProcedure)loader("glGenBuffers");
+    deleteBuffers = (DeleteBuffersProcedure)loader("glDeleteBuffers");
+    bindBuffer = (BindBufferProcedure)loader("glBindBuffer");
+    bufferData = (BufferDataProcedure)loader("glBufferData");
+    getBufferSubData = (GetBufferSubDataProcedure)loader("glGetBufferSubData");
+
+    bufferSupport = genBuffers != nullptr && deleteBuffers != nullptr
+        && bindBuffer != nullptr && bufferData != nullptr;
+}
+
+bool Renderer::hasBuffers() const {
+    return bufferSupport;
+}
+
+void Renderer::setCacheOptimization(bool cacheOptimization) {
+    if (this->cacheOptimization != cacheOptimization)
+        invalidate();
+
+    this->cacheOptimization = cacheOptimization;
+}
+
+bool Renderer::getCacheOptimization() const {
+    return cacheOptimization;
+}
+
+void Renderer::setNormalWeighting(const NormalWeighting & weighting) {
+    if (generator.getWeighting() != weighting)
+        invalidate();
+
+    generator.setWeighting(weighting);
+}
+
+NormalWeighting Renderer::getNormalWeighting() const {
+    return generator.getWeighting();
+}
+
+void Renderer::setCreaseAngle(float creaseAngle) {
+    float previousAngle = generator.getCreaseAngle();
+
+    generator.setCreaseAngle(creaseAngle);
+
+    if (generator.getCreaseAngle() != previousAngle)
+        invalidate();
+}
+
+float Renderer::getCreaseAngle() const {
+    return generator.getCreaseAngle();
+}
+
+void Renderer::load(Geometry * geometry) {
+    updatedMeshCount = 0;
+
+    if (geometry == nullptr) {
+        clear();
+        return;
+    }
+
+    if (geometry == loadedGeometry && geometry->version == loadedVersion)
+        return;
+
+    vector<pair<size_t, size_t> > versions(buffers.size());
+    vector<bool> reused(buffers.size(), false);
+
+    for (size_t i = 0; i < buffers.size(); i++)
+        versions[i] = make_pair(buffers[i].version, i);
+
+    sort(versions.begin(), versions.end());
+
+    vector<MeshBuffer> loaded(geometry->getMeshCount());
+
+    for (size_t i = 0; i < loaded.size(); i++) {
+        MeshBuffer & buffer = loaded[i];
+        size_t version = geometry->getMeshByIndex(i)->version;
+
+        vector<pair<size_t, size_t> >::const_iterator match = lower_bound(versions.begin(),
+            versions.end(), make_pair(version, (size_t)0));
+
+        while (match != versions.end() && match->first == version && reused[match->second])
+            match++;
+
+        if (match != versions.end() && match->first == version) {
+            reused[match->second] = true;
+            swap(buffer, buffers[match->second]);
+        }
+        else {
+            buildMesh(geometry, i, buffer);
+            updatedMeshCount++;
+        }
+
+        if (bufferSupport && buffer.vertexBuffer == 0)
+            uploadMesh(buffer);
+    }
+
+    for (size_t i = 0; i < buffers.size(); i++) {
+        if (!reused[i])
+            releaseMesh(buffers[i], false);
+    }
+
+    buffers.swap(loaded);
+
+    if (bufferSupport) {
+        bindBuffer(GL_ARRAY_BUFFER, 0);
+        bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    loadedGeometry = geometry;
+    loadedVersion = geometry->version;
+}
+
+void Renderer::draw() const {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+
+    for (size_t i = 0; i < buffers.size(); i++) {
+        const MeshBuffer & buffer = buffers[i];
+
+        if (buffer.indexCount == 0)
+            continue;
+
+        const char * vertexData = nullptr;
+        const unsigned int * indexData = nullptr;
+
+        if (bufferSupport) {
+            bindBuffer(GL_ARRAY_BUFFER, buffer.vertexBuffer);
+            bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.indexBuffer);
+        }
+        else {
+            vertexData = (const char *)buffer.vertices.data();
+            indexData = buffer.indices.data();
+        }
+
+        glVertexPointer(3, GL_FLOAT, sizeof(Vertex), vertexData + offsetof(Vertex, position));
+        glNormalPointer(GL_FLOAT, sizeof(Vertex), vertexData + offsetof(Vertex, normal));
+
+        glDrawElements(GL_TRIANGLES, (GLsizei)buffer.indexCount, GL_UNSIGNED_INT, indexData);
+    }
+
+    if (bufferSupport) {
+        bindBuffer(GL_ARRAY_BUFFER, 0);
+        bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void Renderer::release() {
+    for (size_t i = 0; i < buffers.size(); i++)
+        releaseMesh(buffers[i], true);
+
+    if (bufferSupport && !buffers.empty()) {
+        bindBuffer(GL_ARRAY_BUFFER, 0);
+        bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    loadedGeometry = nullptr;
+}
+
+void Renderer::clear() {
+    for (size_t i = 0; i < buffers.size(); i++)
+        releaseMesh(buffers[i], false);
+
+    buffers.clear();
+
+    loadedGeometry = nullptr;
+    updatedMeshCount = 0;
+}
+
+size_t Renderer::getVertexCount() const {
+    size_t vertexCount = 0;
+
+    for (size_t i = 0; i < buffers.size(); i++)
+        vertexCount += buffers[i].vertexCount;
+
+    return vertexCount;
+}
+
+size_t Renderer::getIndexCount() const {
+    size_t indexCount = 0;
+
+    for (size_t i = 0; i < buffers.size(); i++)
+        indexCount += buffers[i].indexCount;
+
+    return indexCount;
+}
+
+size_t Renderer::getBufferSize() const {
+    return getVertexCount() * sizeof(Vertex) + getIndexCount() * sizeof(unsigned int);
+}
+
+float Renderer::getInitialCacheMissRatio() const {
+    size_t triangleCount = getIndexCount() / 3;
+    double missCount = 0;
+
+    for (size_t i = 0; i < buffers.size(); i++)
+        missCount += (double)buffers[i].initialCacheMissRatio * (buffers[i].indexCount / 3);
+
+    return triangleCount != 0 ? (float)(missCount / triangleCount) : 0;
+}
+
+float Renderer::getCacheMissRatio() const {
+    size_t triangleCount = getIndexCount() / 3;
+    double missCount = 0;
+
+    for (size_t i = 0; i < buffers.size(); i++)
+        missCount += (double)buffers[i].cacheMissRatio * (buffers[i].indexCount / 3);
+
+    return triangleCount != 0 ? (float)(missCount / triangleCount) : 0;
+}
+
+size_t Renderer::getUpdatedMeshCount() const {
+    return updatedMeshCount;
+}
+
+void Renderer::invalidate() {
+    for (size_t i = 0; i < buffers.size(); i++)
+        buffers[i].version = 0;
+
+    loadedGeometry = nullptr;
+}
+
+void Renderer::buildMesh(Geometry * geometry, size_t index, MeshBuffer & buffer) {
+    generator.generateMesh(geometry, index);
+
+    packMesh(geometry, index, buffer.vertices, buffer.indices);
+    optimizeMesh(buffer);
+
+    buffer.vertexCount = buffer.vertices.size();
+    buffer.indexCount = buffer.indices.size();
+    buffer.version = geometry->getMeshByIndex(index)->version;
+}
+
+void Renderer::uploadMesh(MeshBuffer & buffer) const {
+    genBuffers(1, &buffer.vertexBuffer);
+    genBuffers(1, &buffer.indexBuffer);
+
+    bindBuffer(GL_ARRAY_BUFFER, buffer.vertexBuffer);
+    bufferData(GL_ARRAY_BUFFER, buffer.vertices.size() * sizeof(Vertex), buffer.vertices.data(),
+        GL_STATIC_DRAW);
+
+    bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.indexBuffer);
+    bufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.indices.size() * sizeof(unsigned int),
+        buffer.indices.data(), GL_STATIC_DRAW);
+
+    vector<Vertex>().swap(buffer.vertices);
+    vector<unsigned int>().swap(buffer.indices);
+}
+
+void Renderer::releaseMesh(MeshBuffer & buffer, bool keep) const {
+    if (bufferSupport && buffer.vertexBuffer != 0) {
+        if (keep && getBufferSubData != nullptr) {
+            buffer.vertices.resize(buffer.vertexCount);
+            buffer.indices.resize(buffer.indexCount);
+
+            bindBuffer(GL_ARRAY_BUFFER, buffer.vertexBuffer);
+            getBufferSubData(GL_ARRAY_BUFFER, 0, buffer.vertexCount * sizeof(Vertex),
+                buffer.vertices.data());
+
+            bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.indexBuffer);
+            getBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, buffer.indexCount * sizeof(unsigned int),
+                buffer.indices.data());
+        }
+        else {
+            buffer.version = 0;
+        }
+
+        deleteBuffers(1, &buffer.vertexBuffer);
+        deleteBuffers(1, &buffer.indexBuffer);
+    }
+
+    buffer.vertexBuffer = 0;
+    buffer.indexBuffer = 0;
+}
+
+void Renderer::packMesh(const Geometry * geometry, size_t index, vector<Vertex> & vertices,
+    vector<unsigned int> & indices) const {
+    const Mesh * mesh = geometry->getMeshByIndex(index);
+    const SurfaceNormals & normals = mesh->normals;
+    const Vector * point = geometry->getPointData();
+
+    size_t cornerCount = mesh->getTriangleCount() * 3;
+    const size_t * vertex = mesh->getIndexData();
+    const size_t * normal = normals.indices.data();
+
+    vertices.resize(normals.getNormalCount());
+    indices.resize(cornerCount);
+
+    Vertex * packed = vertices.data();
+    const Vector * normalData = normals.getNormalData();
+
+    for (size_t i = 0; i < vertices.size(); i++)
+        packed[i].normal = normalData[i];
+
+    for (size_t i = 0; i < cornerCount; i++) {
+        packed[normal[i]].position = point[vertex[i] - 1];
+        indices[i] = (unsigned int)normal[i];
+    }
+}
+
+void Renderer::optimizeMesh(MeshBuffer & buffer) {
+    vector<Vertex> & vertices = buffer.vertices;
+    vector<unsigned int> & indices = buffer.indices;
+
+    buffer.initialCacheMissRatio = 0;
+    buffer.cacheMissRatio = 0;
+
+    if (indices.empty())
+        return;
+
+    if (!cacheOptimization) {
+        buffer.initialCacheMissRatio = VertexCacheOptimizer::getCacheMissRatio(indices.data(),
+            indices.size(), vertices.size(), optimizer.getCacheSize());
+        buffer.cacheMissRatio = buffer.initialCacheMissRatio;
+
+        return;
+    }
+
+    optimizer.optimize(indices.data(), indices.size(), &vertices.data()->position, sizeof(Vertex),
+        vertices.size());
+
+    buffer.initialCacheMissRatio = optimizer.getInitialCacheMissRatio();
+    buffer.cacheMissRatio = optimizer.getCacheMissRatio();
+
+    const vector<unsigned int> & remap = optimizer.getRemap();
+
+    if (remap.empty())
+        return;
+
+    vector<Vertex> ordered(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); i++)
+        ordered[remap[i]] = vertices[i];
+
+    vertices.swap(ordered);
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
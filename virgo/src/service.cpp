@@ -0,0 +1,451 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "service.h"
+#include "parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#define JOB_EXTENSION ".job"
+#define RUNNING_EXTENSION ".running"
+#define RESULT_EXTENSION ".result"
+#define STOP_FILENAME "stop"
+
+VIRGO_NAMESPACE_BEGIN
+
+static bool hasSuffix(const string & text, const char * suffix) {
+    size_t length = strlen(suffix);
+
+    return text.size() > length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+static string trim(const string & text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+
+    if (begin == string::npos)
+        return string();
+
+    size_t end = text.find_last_not_of(" \t\r\n");
+
+    return text.substr(begin, end - begin + 1);
+}
+
+static void writeString(FILE * file, const string & text) {
+    fputc('"', file);
+
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char character = (unsigned char)text[i];
+
+        if (character == '"' || character == '\\')
+            fprintf(file, "\\%c", character);
+        else if (character < 0x20)
+            fprintf(file, "\\u%04x", character);
+        else
+            fputc(character, file);
+    }
+
+    fputc('"', file);
+}
+
+Service::Service() {
+    directory = ".";
+
+    workerCount = 0;
+    memoryLimit = (size_t)1 << 30;
+    pollInterval = 250;
+
+    singleRun = false;
+
+    memoryUsage = 0;
+    activeCount = 0;
+    completedCount = 0;
+    failedCount = 0;
+
+    stopping = false;
+}
+
+Service::~Service() {}
+
+void Service::setDirectory(const string & directory) {
+    this->directory = directory;
+}
+
+const string & Service::getDirectory() const {
+    return directory;
+}
+
+void Service::setWorkerCount(size_t workerCount) {
+    this->workerCount = workerCount;
+}
+
+size_t Service::getWorkerCount() const {
+    return workerCount;
+}
+
+void Service::setMemoryLimit(size_t memoryLimit) {
+    this->memoryLimit = memoryLimit;
+}
+
+size_t Service::getMemoryLimit() const {
+    return memoryLimit;
+}
+
+void Service::setPollInterval(size_t pollInterval) {
+    this->pollInterval = pollInterval;
+}
+
+size_t Service::getPollInterval() const {
+    return pollInterval;
+}
+
+void Service::setSingleRun(bool singleRun) {
+    this->singleRun = singleRun;
+}
+
+bool Service::getSingleRun() const {
+    return singleRun;
+}
+
+int Service::run() {
+    vector<string> names;
+
+    if (!listJobs(names)) {
+        fprintf(stderr, "Unable to read spool directory: %s\n", directory.c_str());
+        return 1;
+    }
+
+    size_t threadCount = workerCount != 0 ? workerCount : getThreadCount();
+    vector<thread> workers;
+
+    stopping = false;
+    completedCount = 0;
+    failedCount = 0;
+
+    printf("Watching %s with %zu workers\n", directory.c_str(), threadCount);
+    fflush(stdout);
+
+    for (size_t i = 0; i < threadCount; i++)
+        workers.push_back(thread(&Service::work, this, i));
+
+    while (true) {
+        size_t pendingCount = claimJobs();
+
+        FILE * stopFile = fopen(getPath(STOP_FILENAME).c_str(), "r");
+
+        if (stopFile != nullptr) {
+            fclose(stopFile);
+            remove(getPath(STOP_FILENAME).c_str());
+            break;
+        }
+
+        unique_lock<mutex> lock(queueMutex);
+
+        if (singleRun && pendingCount == 0 && queue.empty() && activeCount == 0)
+            break;
+
+        queueCondition.wait_for(lock, chrono::milliseconds(pollInterval));
+    }
+
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+
+    queueCondition.notify_all();
+    memoryCondition.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    printf("Processed %zu jobs, %zu failed\n", completedCount, failedCount);
+
+    return 0;
+}
+
+void Service::work(size_t worker) {
+    size_t threadCount = workerCount != 0 ? workerCount : getThreadCount();
+
+    Batch batch;
+    batch.setVerbose(false);
+    batch.setDirectory(directory);
+    batch.setThreadCount(max<size_t>(1, getThreadCount() / threadCount));
+
+    while (true) {
+        Job job;
+
+        {
+            unique_lock<mutex> lock(queueMutex);
+
+            while (queue.empty() && !stopping)
+                queueCondition.wait(lock);
+
+            if (queue.empty())
+                return;
+
+            job = queue.front();
+            queue.pop_front();
+
+            activeCount++;
+        }
+
+        queueCondition.notify_all();
+
+        processJob(batch, job, worker);
+
+        {
+            lock_guard<mutex> lock(queueMutex);
+            activeCount--;
+        }
+
+        queueCondition.notify_all();
+    }
+}
+
+void Service::processJob(Batch & batch, const Job & job, size_t worker) {
+    double queueTime = job.timer.getElapsedTime();
+
+    vector<string> arguments;
+    string error;
+
+    batch.reset();
+
+    bool status = readJob(job.name, arguments);
+
+    if (!status)
+        error = "Unable to read job";
+    else if (!(status = batch.parse(arguments)))
+        error = batch.getError();
+
+    if (status) {
+        size_t memory = min(batch.estimateMemory(), memoryLimit);
+
+        {
+            unique_lock<mutex> lock(queueMutex);
+
+            while (memoryUsage != 0 && memoryUsage + memory > memoryLimit)
+                memoryCondition.wait(lock);
+
+            memoryUsage += memory;
+        }
+
+        status = batch.run() == 0;
+        error = batch.getError();
+
+        {
+            lock_guard<mutex> lock(queueMutex);
+            memoryUsage -= memory;
+        }
+
+        memoryCondition.notify_all();
+    }
+
+    if (!writeResult(job.name, batch, status, error, queueTime, worker))
+        status = false;
+
+    remove(getPath(job.name + RUNNING_EXTENSION).c_str());
+
+    lock_guard<mutex> lock(queueMutex);
+
+    completedCount++;
+
+    if (!status)
+        failedCount++;
+
+    printf("%s: %s in %.3f s\n", job.name.c_str(), status ? "done" : "failed", batch.getTotalTime());
+    fflush(stdout);
+}
+
+size_t Service::claimJobs() {
+    vector<string> names;
+
+    if (!listJobs(names))
+        return 0;
+
+    size_t threadCount = workerCount != 0 ? workerCount : getThreadCount();
+
+    sort(names.begin(), names.end());
+
+    for (size_t i = 0; i < names.size(); i++) {
+        {
+            lock_guard<mutex> lock(queueMutex);
+
+            if (queue.size() >= threadCount * 2)
+                break;
+        }
+
+        string jobPath = getPath(names[i] + JOB_EXTENSION);
+        string runningPath = getPath(names[i] + RUNNING_EXTENSION);
+
+        if (rename(jobPath.c_str(), runningPath.c_str()) != 0)
+            continue;
+
+        Job job;
+        job.name = names[i];
+
+        {
+            lock_guard<mutex> lock(queueMutex);
+            queue.push_back(job);
+        }
+
+        queueCondition.notify_one();
+    }
+
+    return names.size();
+}
+
+bool Service::listJobs(vector<string> & names) const {
+    names.clear();
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA(getPath("*" JOB_EXTENSION).c_str(), &data);
+
+    if (handle == INVALID_HANDLE_VALUE)
+        return GetLastError() == ERROR_FILE_NOT_FOUND;
+
+    do {
+        string name = data.cFileName;
+
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && hasSuffix(name, JOB_EXTENSION))
+            names.push_back(name.substr(0, name.size() - strlen(JOB_EXTENSION)));
+    } while (FindNextFileA(handle, &data));
+
+    FindClose(handle);
+#else
+    DIR * handle = opendir(directory.c_str());
+
+    if (handle == nullptr)
+        return false;
+
+    while (dirent * entry = readdir(handle)) {
+        string name = entry->d_name;
+
+        if (hasSuffix(name, JOB_EXTENSION))
+            names.push_back(name.substr(0, name.size() - strlen(JOB_EXTENSION)));
+    }
+
+    closedir(handle);
+#endif
+
+    return true;
+}
+
+bool Service::readJob(const string & name, vector<string> & arguments) const {
+    FILE * file = fopen(getPath(name + RUNNING_EXTENSION).c_str(), "r");
+
+    if (file == nullptr)
+        return false;
+
+    char buffer[4096];
+
+    while (fgets(buffer, sizeof(buffer), file) != nullptr) {
+        string line = trim(buffer);
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        size_t separator = line.find_first_of(" \t");
+        string option = line.substr(0, separator);
+
+        if (option.compare(0, 2, "--") != 0)
+            option = "--" + option;
+
+        arguments.push_back(option);
+
+        if (separator != string::npos)
+            arguments.push_back(trim(line.substr(separator)));
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+bool Service::writeResult(const string & name, const Batch & batch, bool status,
+    const string & error, double queueTime, size_t worker) const {
+    string resultPath = getPath(name + RESULT_EXTENSION);
+    string temporaryPath = resultPath + ".tmp";
+
+    FILE * file = fopen(temporaryPath.c_str(), "w");
+
+    if (file == nullptr)
+        return false;
+
+    const vector<BatchStep> & steps = batch.getSteps();
+
+    fprintf(file, "{\n  \"job\": ");
+    writeString(file, name);
+    fprintf(file, ",\n  \"status\": \"%s\",\n  \"error\": ", status ? "ok" : "failed");
+    writeString(file, error);
+    fprintf(file, ",\n  \"worker\": %zu,\n  \"queueTime\": %.6f,\n  \"time\": %.6f,\n  \"steps\": [",
+        worker, queueTime, batch.getTotalTime());
+
+    bool failed = false;
+
+    for (size_t i = 0; i < steps.size(); i++) {
+        const BatchStep & step = steps[i];
+
+        fprintf(file, "%s\n    {\"command\": \"%s\", \"argument\": ", i != 0 ? "," : "",
+            Batch::getCommandName(step.command));
+        writeString(file, step.argument);
+        fprintf(file, ", \"time\": %.6f, \"status\": \"%s\"}", step.time,
+            step.status ? "ok" : (failed ? "skipped" : "failed"));
+
+        failed = failed || !step.status;
+    }
+
+    fprintf(file, "%s]\n}\n", steps.empty() ? "" : "\n  ");
+
+    bool written = ferror(file) == 0;
+
+    fclose(file);
+
+    remove(resultPath.c_str());
+
+    return written && rename(temporaryPath.c_str(), resultPath.c_str()) == 0;
+}
+
+string Service::getPath(const string & name) const {
+#ifdef _WIN32
+    return directory + "\\" + name;
+#else
+    return directory + "/" + name;
+#endif
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
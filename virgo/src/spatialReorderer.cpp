@@ -0,0 +1,355 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "spatialReorderer.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <mutex>
+
+#define KEY_BITS 21
+#define PARALLEL_THRESHOLD 65536
+
+VIRGO_NAMESPACE_BEGIN
+
+struct VertexItem {
+    size_t owner;
+    uint64_t key;
+    size_t index;
+};
+
+static uint64_t spreadBits(uint64_t value) {
+    value &= 0x1FFFFF;
+    value = (value | value << 32) & 0x1F00000000FFFFULL;
+    value = (value | value << 16) & 0x1F0000FF0000FFULL;
+    value = (value | value << 8) & 0x100F00F00F00F00FULL;
+    value = (value | value << 4) & 0x10C30C30C30C30C3ULL;
+    value = (value | value << 2) & 0x1249249249249249ULL;
+
+    return value;
+}
+
+static uint64_t getMortonKey(uint32_t x, uint32_t y, uint32_t z) {
+    return spreadBits(x) << 2 | spreadBits(y) << 1 | spreadBits(z);
+}
+
+static uint64_t getHilbertKey(uint32_t x, uint32_t y, uint32_t z) {
+    uint32_t axes[3] = { x, y, z };
+    uint32_t highest = 1u << (KEY_BITS - 1);
+
+    for (uint32_t bit = highest; bit > 1; bit >>= 1) {
+        uint32_t mask = bit - 1;
+
+        for (size_t i = 0; i < 3; i++) {
+            uint32_t inverted = axes[i] & bit ? mask : 0;
+            uint32_t swapped = (axes[0] ^ axes[i]) & mask & ~inverted;
+
+            axes[0] ^= inverted ^ swapped;
+            axes[i] ^= swapped;
+        }
+    }
+
+    axes[1] ^= axes[0];
+    axes[2] ^= axes[1];
+
+    uint32_t flip = 0;
+
+    for (uint32_t bit = highest; bit > 1; bit >>= 1)
+        flip ^= axes[2] & bit ? bit - 1 : 0;
+
+    return getMortonKey(axes[0] ^ flip, axes[1] ^ flip, axes[2] ^ flip);
+}
+
+static uint32_t quantize(float value, float minimum, float scale) {
+    float position = (value - minimum) * scale;
+    uint32_t maximum = (1u << KEY_BITS) - 1;
+
+    if (!(position > 0))
+        return 0;
+
+    return position < maximum ? (uint32_t)position : maximum;
+}
+
+static bool isLess(const VertexItem & first, const VertexItem & second) {
+    if (first.owner != second.owner)
+        return first.owner < second.owner;
+
+    if (first.key != second.key)
+        return first.key < second.key;
+
+    return first.index < second.index;
+}
+
+static bool isLess(const Triangle & first, const Triangle & second) {
+    if (first.v1 != second.v1)
+        return first.v1 < second.v1;
+
+    if (first.v2 != second.v2)
+        return first.v2 < second.v2;
+
+    return first.v3 < second.v3;
+}
+
+static void rotateTriangle(Triangle & triangle) {
+    if (triangle.v2 < triangle.v1 && triangle.v2 < triangle.v3)
+        triangle = Triangle(triangle.v2, triangle.v3, triangle.v1);
+    else if (triangle.v3 < triangle.v1 && triangle.v3 < triangle.v2)
+        triangle = Triangle(triangle.v3, triangle.v1, triangle.v2);
+}
+
+template <typename Item, typename Less>
+static void sortItems(Item * items, size_t count, const Less & less, size_t workerCount) {
+    size_t blockCount = count < PARALLEL_THRESHOLD ? 1 : min(workerCount, count);
+
+    if (blockCount <= 1) {
+        sort(items, items + count, less);
+        return;
+    }
+
+    vector<size_t> bounds(blockCount + 1);
+
+    for (size_t i = 0; i <= blockCount; i++)
+        bounds[i] = count * i / blockCount;
+
+    parallelFor(blockCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+            sort(items + bounds[i], items + bounds[i + 1], less);
+    }, workerCount);
+
+    vector<Item> buffer(count);
+
+    Item * source = items;
+    Item * target = buffer.data();
+
+    for (size_t width = 1; width < blockCount; width *= 2) {
+        size_t pairCount = (blockCount + width * 2 - 1) / (width * 2);
+
+        parallelFor(pairCount, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                size_t begin = bounds[i * width * 2];
+                size_t middle = bounds[min(i * width * 2 + width, blockCount)];
+                size_t end = bounds[min(i * width * 2 + width * 2, blockCount)];
+
+                merge(source + begin, source + middle, source + middle, source + end,
+                    target + begin, less);
+            }
+        }, workerCount);
+
+        swap(source, target);
+    }
+
+    if (source != items)
+        copy(source, source + count, items);
+}
+
+static void markOwners(const Mesh * mesh, size_t index, vector<size_t> & owners) {
+    const size_t * vertex = mesh->getIndexData();
+
+    for (size_t i = 0; i < mesh->getTriangleCount() * 3; i++, vertex++) {
+        if (owners[*vertex - 1] == SIZE_MAX)
+            owners[*vertex - 1] = index;
+    }
+
+    vertex = mesh->volume.getIndexData();
+
+    for (size_t i = 0; i < mesh->volume.getTetrahedronCount() * 4; i++, vertex++) {
+        if (owners[*vertex - 1] == SIZE_MAX)
+            owners[*vertex - 1] = index;
+    }
+}
+
+static void remapMesh(Mesh * mesh, const vector<size_t> & indices, size_t workerCount) {
+    size_t * triangleVertices = mesh->getIndexData();
+    size_t * tetrahedronVertices = mesh->volume.getIndexData();
+
+    parallelFor(mesh->getTriangleCount() * 3, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+            triangleVertices[i] = indices[triangleVertices[i] - 1] + 1;
+    }, workerCount);
+
+    parallelFor(mesh->volume.getTetrahedronCount() * 4, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+            tetrahedronVertices[i] = indices[tetrahedronVertices[i] - 1] + 1;
+    }, workerCount);
+}
+
+SpatialReorderer::SpatialReorderer() {
+    ordering = VertexOrdering::HilbertOrdering;
+    threadCount = 0;
+    progress = nullptr;
+}
+
+SpatialReorderer::~SpatialReorderer() {}
+
+void SpatialReorderer::setOrdering(const VertexOrdering & ordering) {
+    this->ordering = ordering;
+}
+
+VertexOrdering SpatialReorderer::getOrdering() const {
+    return ordering;
+}
+
+void SpatialReorderer::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+}
+
+size_t SpatialReorderer::getThreadCount() const {
+    return threadCount;
+}
+
+void SpatialReorderer::setProgress(Progress * progress) {
+    this->progress = progress;
+}
+
+Progress * SpatialReorderer::getProgress() const {
+    return progress;
+}
+
+void SpatialReorderer::reorderGeometry(Geometry * geometry) {
+    size_t workerCount = threadCount != 0 ? threadCount : virgo::getThreadCount();
+
+    remap.clear();
+
+    if (ordering == VertexOrdering::FileOrdering || geometry->getVertexCount() == 0)
+        return;
+
+    if (progress != nullptr) {
+        progress->setPhase(ProgressPhase::ReorderingPhase);
+        progress->setTotal(geometry->getVertexCount() + geometry->getPolygonCount());
+    }
+
+    reorderVertices(geometry, workerCount);
+
+    if (progress != nullptr)
+        progress->advance(geometry->getVertexCount());
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
+        Mesh * mesh = geometry->getMeshByIndex(i);
+
+        reorderTriangles(mesh, workerCount);
+        geometry->invalidateMesh(i);
+
+        if (progress != nullptr)
+            progress->advance(mesh->getTriangleCount());
+    }
+}
+
+const vector<size_t> & SpatialReorderer::getRemap() const {
+    return remap;
+}
+
+void SpatialReorderer::reorderVertices(Geometry * geometry, size_t workerCount) {
+    size_t vertexCount = geometry->getVertexCount();
+    Vector * points = geometry->points.data();
+
+    vector<size_t> owners(vertexCount, SIZE_MAX);
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++)
+        markOwners(geometry->getMeshByIndex(i), i, owners);
+
+    Vector minimum(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector maximum(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    mutex lock;
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        Vector localMinimum(FLT_MAX, FLT_MAX, FLT_MAX);
+        Vector localMaximum(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+        for (size_t i = first; i < last; i++) {
+            for (size_t j = 0; j < 3; j++) {
+                localMinimum[j] = min(localMinimum[j], points[i][j]);
+                localMaximum[j] = max(localMaximum[j], points[i][j]);
+            }
+        }
+
+        lock_guard<mutex> guard(lock);
+
+        for (size_t j = 0; j < 3; j++) {
+            minimum[j] = min(minimum[j], localMinimum[j]);
+            maximum[j] = max(maximum[j], localMaximum[j]);
+        }
+    }, workerCount);
+
+    Vector extent = maximum - minimum;
+    float size = max(extent.x, max(extent.y, extent.z));
+    float scale = size > 0 ? ((1u << KEY_BITS) - 1) / size : 0;
+
+    vector<VertexItem> items(vertexCount);
+    bool hilbert = ordering == VertexOrdering::HilbertOrdering;
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            uint32_t x = quantize(points[i].x, minimum.x, scale);
+            uint32_t y = quantize(points[i].y, minimum.y, scale);
+            uint32_t z = quantize(points[i].z, minimum.z, scale);
+
+            items[i].owner = owners[i];
+            items[i].key = hilbert ? getHilbertKey(x, y, z) : getMortonKey(x, y, z);
+            items[i].index = i;
+        }
+    }, workerCount);
+
+    sortItems(items.data(), vertexCount, [](const VertexItem & first, const VertexItem & second) {
+        return isLess(first, second);
+    }, workerCount);
+
+    remap.resize(vertexCount);
+
+    vector<Vector> sorted(vertexCount);
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            remap[items[i].index] = i;
+            sorted[i] = points[items[i].index];
+        }
+    }, workerCount);
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        copy(sorted.data() + first, sorted.data() + last, points + first);
+    }, workerCount);
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++)
+        remapMesh(geometry->getMeshByIndex(i), remap, workerCount);
+}
+
+void SpatialReorderer::reorderTriangles(Mesh * mesh, size_t workerCount) {
+    Triangle * triangles = mesh->triangles.data();
+    size_t triangleCount = mesh->getTriangleCount();
+
+    parallelFor(triangleCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+            rotateTriangle(triangles[i]);
+    }, workerCount);
+
+    sortItems(triangles, triangleCount, [](const Triangle & first, const Triangle & second) {
+        return isLess(first, second);
+    }, workerCount);
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
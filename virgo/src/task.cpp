@@ -0,0 +1,102 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "task.h"
+
+VIRGO_NAMESPACE_BEGIN
+
+Task::Task() {}
+
+Task::~Task() {
+    if (worker.joinable()) {
+        cancel();
+        wait();
+    }
+}
+
+bool Task::start(const function<TaskStatus(Progress *)> & job) {
+    if (worker.joinable())
+        return false;
+
+    shared_ptr<State> state = make_shared<State>();
+    state->finished = false;
+    state->status = TaskStatus::FailedStatus;
+
+    this->state = state;
+
+    worker = thread([job, state]() {
+        try {
+            state->status = job(&state->progress);
+        }
+        catch (...) {
+            state->status = TaskStatus::FailedStatus;
+        }
+
+        state->finished = true;
+    });
+
+    return true;
+}
+
+void Task::cancel() {
+    if (state != nullptr)
+        state->progress.cancel();
+}
+
+TaskStatus Task::wait() {
+    if (!worker.joinable())
+        return TaskStatus::FailedStatus;
+
+    worker.join();
+
+    TaskStatus status = state->progress.isCancelled() ? TaskStatus::CancelledStatus : state->status;
+    state = nullptr;
+
+    return status;
+}
+
+void Task::detach() {
+    if (!worker.joinable())
+        return;
+
+    worker.detach();
+    state = nullptr;
+}
+
+bool Task::isActive() const {
+    return worker.joinable();
+}
+
+bool Task::isFinished() const {
+    return worker.joinable() && state->finished;
+}
+
+const Progress * Task::getProgress() const {
+    return state != nullptr ? &state->progress : nullptr;
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
@@ -26,6 +26,9 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "tetrahedralMeshGenerator.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
 #include <vector>
 #include <tetgen.h>
 
@@ -33,114 +36,364 @@ VIRGO_NAMESPACE_BEGIN
 
 using namespace std;
 
-TetrahedralMeshGenerator::TetrahedralMeshGenerator() {}
+template <typename T>
+static void releaseArray(T *& array) {
+    delete[] array;
+    array = nullptr;
+}
+
+TetrahedralMeshGenerator::TetrahedralMeshGenerator() {
+    neighborOutput = false;
+    regionAttributes = false;
+
+    threadCount = 0;
+    progress = nullptr;
+}
+
 TetrahedralMeshGenerator::~TetrahedralMeshGenerator() {}
 
+void TetrahedralMeshGenerator::setNeighborOutput(bool neighborOutput) {
+    this->neighborOutput = neighborOutput;
+}
+
+bool TetrahedralMeshGenerator::getNeighborOutput() const {
+    return neighborOutput;
+}
+
+void TetrahedralMeshGenerator::setRegionAttributes(bool regionAttributes) {
+    this->regionAttributes = regionAttributes;
+}
+
+bool TetrahedralMeshGenerator::getRegionAttributes() const {
+    return regionAttributes;
+}
+
+void TetrahedralMeshGenerator::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+}
+
+size_t TetrahedralMeshGenerator::getThreadCount() const {
+    return threadCount;
+}
+
+void TetrahedralMeshGenerator::setProgress(Progress * progress) {
+    this->progress = progress;
+}
+
+Progress * TetrahedralMeshGenerator::getProgress() const {
+    return progress;
+}
+
 void TetrahedralMeshGenerator::tetrahedralizeMesh(Geometry * geometry, size_t index,
     float radiusEdgeRatio) const {
     Mesh * mesh = geometry->getMeshByIndex(index);
 
-    if (mesh == nullptr)
+    if (mesh == nullptr || isCancelled())
         return;
 
-    vector<Vector *> points;
-    vector<Triangle *> triangles;
-
-    geometry->getMeshDataByIndex(index, points, triangles);
-
-    size_t offset = geometry->getVertexCount();
+    if (progress != nullptr) {
+        progress->setPhase(ProgressPhase::PreparingPhase);
+        progress->setTotal(1);
+    }
 
     tetgenio * input = new tetgenio;
     tetgenio * output = new tetgenio;
 
-    input->firstnumber = 1;
-    output->firstnumber = 1;
+    tetgenbehavior behavior;
+    createBehavior(behavior, radiusEdgeRatio);
 
-    tetgenio::facet * facet = nullptr;
-    tetgenio::polygon * polygon = nullptr;
+    createInput(geometry, index, input);
 
-    tetgenbehavior behavior;
+    if (isCancelled()) {
+        releaseInput(input);
+        delete output;
+
+        return;
+    }
+
+    mesh->triangles.clear();
+    mesh->triangles.shrink_to_fit();
+
+    mesh->volume.clear();
+    geometry->invalidateMesh(index);
+
+    if (progress != nullptr)
+        progress->setPhase(ProgressPhase::MeshingPhase);
+
+    try {
+        tetrahedralize(&behavior, input, output);
+    }
+    catch (...) {
+        releaseInput(input);
+        delete output;
+
+        throw;
+    }
+
+    releaseInput(input);
+
+    if (!isCancelled()) {
+        if (progress != nullptr)
+            progress->setPhase(ProgressPhase::StoringPhase);
+
+        storeOutput(geometry, index, output);
+
+        if (progress != nullptr)
+            progress->advance(1);
+    }
+
+    delete output;
+}
+
+void TetrahedralMeshGenerator::tetrahedralizeAll(Geometry * geometry, float radiusEdgeRatio) const {
+    size_t meshCount = geometry->getMeshCount();
+
+    if (meshCount == 0 || isCancelled())
+        return;
+
+    if (progress != nullptr) {
+        progress->setPhase(ProgressPhase::MeshingPhase);
+        progress->setTotal(meshCount);
+    }
+
+    size_t workerCount = threadCount != 0 ? threadCount : virgo::getThreadCount();
+    workerCount = min(workerCount, meshCount);
+
+    vector<size_t> order(meshCount);
+    vector<tetgenio *> outputs(meshCount, nullptr);
+
+    for (size_t i = 0; i < meshCount; i++)
+        order[i] = i;
+
+    stable_sort(order.begin(), order.end(), [&](size_t first, size_t second) {
+        return geometry->getMeshByIndex(first)->getTriangleCount()
+            > geometry->getMeshByIndex(second)->getTriangleCount();
+    });
+
+    atomic<size_t> next(0);
+    atomic<bool> failed(false);
+
+    try {
+        parallelFor(workerCount, [&](size_t, size_t) {
+            for (size_t i = next++; i < meshCount && !failed && !isCancelled(); i = next++) {
+                size_t index = order[i];
+
+                tetgenio * input = new tetgenio;
+                tetgenio * output = new tetgenio;
+
+                tetgenbehavior behavior;
+                createBehavior(behavior, radiusEdgeRatio);
+
+                createInput(geometry, index, input);
+                outputs[index] = output;
+
+                try {
+                    tetrahedralize(&behavior, input, output);
+                }
+                catch (...) {
+                    releaseInput(input);
+                    failed = true;
+
+                    throw;
+                }
+
+                releaseInput(input);
+
+                if (progress != nullptr)
+                    progress->advance(1);
+            }
+        }, workerCount);
+    }
+    catch (...) {
+        for (size_t i = 0; i < meshCount; i++)
+            delete outputs[i];
+
+        throw;
+    }
+
+    if (isCancelled()) {
+        for (size_t i = 0; i < meshCount; i++)
+            delete outputs[i];
+
+        return;
+    }
+
+    if (progress != nullptr)
+        progress->setPhase(ProgressPhase::StoringPhase);
+
+    for (size_t i = 0; i < meshCount; i++) {
+        storeOutput(geometry, i, outputs[i]);
+
+        delete outputs[i];
+    }
+}
+
+bool TetrahedralMeshGenerator::isCancelled() const {
+    return progress != nullptr && progress->isCancelled();
+}
+
+void TetrahedralMeshGenerator::createBehavior(tetgenbehavior & behavior, float radiusEdgeRatio) const {
     behavior.plc = 1;
     behavior.quality = 1;
     behavior.order = 0;
     behavior.facesout = 1;
     behavior.quiet = 1;
+    behavior.neighout = neighborOutput ? 1 : 0;
+    behavior.regionattrib = regionAttributes ? 1 : 0;
     behavior.minratio = radiusEdgeRatio;
 
-    input->numberofpoints = (int)points.size();
-    input->pointlist = new double[input->numberofpoints * 3];
+    // Every run calls exactinit, which writes process-wide predicate globals. Runs from other
+    // generators or service workers may be live, so the static filter is always disabled.
+    behavior.nostaticfilter = 1;
+}
+
+void TetrahedralMeshGenerator::createInput(const Geometry * geometry, size_t index,
+    tetgenio * input) const {
+    const Mesh * mesh = geometry->getMeshByIndex(index);
+
+    size_t triangleCount = mesh->getTriangleCount();
+    size_t vertexCount = geometry->getVertexCount();
+
+    input->firstnumber = 1;
+
+    if (triangleCount == 0)
+        return;
+
+    vector<int> remap(vertexCount, 0);
+
+    int * vertexList = new int[triangleCount * 3];
+    int pointCount = 0;
+
+    const size_t * vertex = mesh->getIndexData();
+
+    for (size_t i = 0; i < triangleCount * 3; i++, vertex++) {
+        int & target = remap[*vertex - 1];
 
-    for (int i = 0; i < input->numberofpoints; i++) {
-        input->pointlist[i * 3] = points[i]->x;
-        input->pointlist[i * 3 + 1] = points[i]->y;
-        input->pointlist[i * 3 + 2] = points[i]->z;
+        if (target == 0)
+            target = ++pointCount;
+
+        vertexList[i] = target;
     }
 
-    input->numberoffacets = (int)triangles.size();
-    input->facetlist = new tetgenio::facet[input->numberoffacets];
+    input->numberofpoints = pointCount;
+    input->pointlist = new double[pointCount * 3];
+
+    const Vector * point = geometry->getPointData();
 
-    for (int i = 0; i < input->numberoffacets; i++) {
-        facet = &input->facetlist[i];
-        facet->numberofpolygons = 1;
-        facet->polygonlist = new tetgenio::polygon[facet->numberofpolygons];
-        facet->numberofholes = 0;
-        facet->holelist = nullptr;
+    for (size_t i = 0; i < vertexCount; i++, point++) {
+        if (remap[i] != 0) {
+            double * target = &input->pointlist[(remap[i] - 1) * 3];
 
-        polygon = &facet->polygonlist[0];
-        polygon->numberofvertices = 3;
-        polygon->vertexlist = new int[polygon->numberofvertices];
-        polygon->vertexlist[0] = (int)triangles[i]->v1;
-        polygon->vertexlist[1] = (int)triangles[i]->v2;
-        polygon->vertexlist[2] = (int)triangles[i]->v3;
+            target[0] = point->x;
+            target[1] = point->y;
+            target[2] = point->z;
+        }
     }
 
-    for (size_t i = 0; i < points.size(); i++) {
-        if (points[i] != nullptr)
-            delete points[i];
+    tetgenio::polygon * polygons = new tetgenio::polygon[triangleCount];
+
+    input->numberoffacets = (int)triangleCount;
+    input->facetlist = new tetgenio::facet[triangleCount];
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        tetgenio::facet & facet = input->facetlist[i];
+        facet.numberofpolygons = 1;
+        facet.polygonlist = &polygons[i];
+        facet.numberofholes = 0;
+        facet.holelist = nullptr;
+
+        polygons[i].numberofvertices = 3;
+        polygons[i].vertexlist = &vertexList[i * 3];
     }
+}
 
-    for (size_t i = 0; i < triangles.size(); i++) {
-        if (triangles[i] != nullptr)
-            delete triangles[i];
+void TetrahedralMeshGenerator::releaseInput(tetgenio * input) const {
+    if (input->numberoffacets != 0) {
+        delete[] input->facetlist[0].polygonlist[0].vertexlist;
+        delete[] input->facetlist[0].polygonlist;
     }
 
-    points.clear();
-    triangles.clear();
+    delete[] input->facetlist;
 
-    for (size_t i = 0; i < mesh->triangles.size(); i++) {
-        if (mesh->triangles[i] != nullptr)
-            delete mesh->triangles[i];
-    }
+    input->facetlist = nullptr;
+    input->numberoffacets = 0;
+
+    delete input;
+}
+
+void TetrahedralMeshGenerator::storeOutput(Geometry * geometry, size_t index,
+    tetgenio * output) const {
+    Mesh * mesh = geometry->getMeshByIndex(index);
+    size_t offset = geometry->getVertexCount();
+
+    releaseArray(output->pointmarkerlist);
+    releaseArray(output->trifacemarkerlist);
+    releaseArray(output->adjtetlist);
+
+    geometry->points.resize(offset + output->numberofpoints);
+
+    const double * coordinate = output->pointlist;
+    Vector * point = &geometry->points[offset];
+
+    for (int i = 0; i < output->numberofpoints; i++, point++, coordinate += 3)
+        point->setValue((float)coordinate[0], (float)coordinate[1], (float)coordinate[2]);
+
+    releaseArray(output->pointlist);
 
     mesh->triangles.clear();
-    
-    tetrahedralize(&behavior, input, output);
+    mesh->triangles.resize(output->numberoftrifaces);
+
+    geometry->invalidateMesh(index);
+
+    const int * face = output->trifacelist;
+    Triangle * triangle = mesh->triangles.data();
+
+    for (int i = 0; i < output->numberoftrifaces; i++, triangle++, face += 3) {
+        triangle->v1 = (size_t)face[2] + offset;
+        triangle->v2 = (size_t)face[1] + offset;
+        triangle->v3 = (size_t)face[0] + offset;
+    }
+
+    releaseArray(output->trifacelist);
 
-    Vector * point = nullptr;
-    Triangle * triangle = nullptr;
+    TetrahedralMesh & volume = mesh->volume;
 
-    for (int i = 0; i < output->numberofpoints; i++) {
-        point = new Vector;
+    volume.clear();
+    volume.tetrahedra.resize(output->numberoftetrahedra);
 
-        point->x = output->pointlist[i * 3];
-        point->y = output->pointlist[i * 3 + 1];
-        point->z = output->pointlist[i * 3 + 2];
+    const int * corner = output->tetrahedronlist;
+    Tetrahedron * tetrahedron = volume.tetrahedra.data();
 
-        geometry->points.push_back(point);
+    for (int i = 0; i < output->numberoftetrahedra; i++, tetrahedron++) {
+        tetrahedron->v1 = (size_t)corner[0] + offset;
+        tetrahedron->v2 = (size_t)corner[1] + offset;
+        tetrahedron->v3 = (size_t)corner[2] + offset;
+        tetrahedron->v4 = (size_t)corner[3] + offset;
+
+        corner += output->numberofcorners;
     }
 
-    for (int i = 0; i < output->numberoftrifaces; i++) {
-        triangle = new Triangle;
+    releaseArray(output->tetrahedronlist);
+
+    if (output->neighborlist != nullptr) {
+        volume.neighbors.resize(output->numberoftetrahedra * 4);
 
-        triangle->v1 = (size_t)output->trifacelist[i * 3 + 2] + offset;
-        triangle->v2 = (size_t)output->trifacelist[i * 3 + 1] + offset;
-        triangle->v3 = (size_t)output->trifacelist[i * 3] + offset;
+        const int * neighbor = output->neighborlist;
+        size_t * target = volume.neighbors.data();
 
-        mesh->triangles.push_back(triangle);
+        for (int i = 0; i < output->numberoftetrahedra * 4; i++)
+            target[i] = neighbor[i] > 0 ? (size_t)neighbor[i] : 0;
+
+        releaseArray(output->neighborlist);
     }
 
-    delete input;
-    delete output;
+    if (output->tetrahedronattributelist != nullptr) {
+        volume.attributeCount = output->numberoftetrahedronattributes;
+        volume.attributes.assign(output->tetrahedronattributelist,
+            output->tetrahedronattributelist + output->numberoftetrahedra * volume.attributeCount);
+
+        releaseArray(output->tetrahedronattributelist);
+    }
 }
 
 VIRGO_NAMESPACE_END
\ No newline at end of file
@@ -61,15 +61,22 @@ void Translator::setEnglishLanguage() {
     INFORMATION = "Information";
     VIEWPORT = "Viewport";
     TETRAHEDRALIZE = "Tetrahedralize";
+    DECIMATE = "Decimate";
     DELETE = "Delete";
     EXPORT = "Export";
     SAVE = "Save";
     CLOSE = "Close";
     PREFERENCES = "Preferences";
     ABOUT = "About";
+    PROGRESS = "Progress";
     EXIT = "Exit";
     CURRENT_FILE = "File: %s\n";
     NO_FILE = "File: No file selected";
+    OPERATION_PROGRESS = "Operation: %s %.1f%%\n";
+    OPERATION_CANCELLED = "Operation: Cancelled";
+    INVALID_FILE = "Operation: Invalid or unsupported file";
+    OPERATION_FAILED = "Operation: Failed";
+    OPERATION_RUNNING = "Wait for the current operation to finish or cancel it.";
     OPEN_FILE = "Enter a filename to open:";
     IMPORT_FILE = "Enter an object file to import:";
     MESHES = "Meshes:";
@@ -77,8 +84,16 @@ void Translator::setEnglishLanguage() {
     VERTEX_COUNT = "Vertex count: %zu\n";
     POLYGON_COUNT = "Polygon count: %zu\n";
     MESH_COUNT = "Mesh count: %zu\n";
+    TETRAHEDRON_COUNT = "Tetrahedron count: %zu\n";
+    MEMORY_USAGE = "Memory usage: %.2f MB of %.2f MB reserved\n";
+    PEAK_MEMORY_USAGE = "Process memory: %.2f MB, peak %.2f MB\n";
+    READ_STATISTICS = "Last read: %.2f MB in %.3f s (%.2f MB/s)\n";
     TETRAHEDRALIZE_MESH = "Select a mesh to tetrahedralize:";
+    DECIMATE_MESH = "Select a mesh to decimate:";
+    ALL_MESHES = "All meshes";
     EDGE_RATIO_PARAMETER = "Enter the radius-edge ratio parameter:";
+    TARGET_TRIANGLE_COUNT = "Enter the target triangle count (0 for no limit):";
+    MAXIMUM_ERROR = "Enter the maximum error (0 for no limit):";
     DELETE_MESH = "Select a mesh to delete:";
     EXPORT_MESH = "Select a mesh to export:";
     EXPORT_FILE = "Enter a filename to save mesh:";
@@ -91,18 +106,31 @@ void Translator::setEnglishLanguage() {
     DEFAULT_THEME = "Select a default theme for application:";
     LIGHT = "White";
     DARK = "Dark";
+    DEFAULT_ORDERING = "Select a default vertex ordering for opened files:";
+    FILE_ORDERING = "File order";
+    MORTON_ORDERING = "Morton curve";
+    HILBERT_ORDERING = "Hilbert curve";
     ABOUT_VIRGO = "Virgo offers an interative feature set for 3D computer visualization.";
     DEPENDENCIES = "Dependencies";
     OPENING = "Opening...";
     IMPORTING = "Importing...";
     TETRAHEDRALIZING = "Tetrahedralizing...";
+    DECIMATING = "Decimating...";
+    REORDERING = "Reordering...";
     DELETING = "Deleting...";
     EXPORTING = "Exporting...";
     SAVING = "Saving...";
+    PREPARING = "Preparing...";
+    STORING = "Storing...";
+    CANCELLING = "Cancelling...";
     YES = "YES";
     NO = "NO";
     OK = "OK";
     CANCEL = "Cancel";
+    CANCEL_OPERATION = "Cancel operation";
+    SELF_INTERSECTION = "The mesh %s intersects itself at %zu triangle pairs:\n";
+    INTERSECTING_FACES = "Faces %zu and %zu\n";
+    MORE_INTERSECTIONS = "And %zu more\n";
 }
 
 void Translator::setPortugueseLanguage() {
@@ -111,15 +139,22 @@ void Translator::setPortugueseLanguage() {
     INFORMATION = "Informao";
     VIEWPORT = "Visualizar";
     TETRAHEDRALIZE = "Tetraedralizar";
+    DECIMATE = "Simplificar";
     DELETE = "Deletar";
     EXPORT = "Exportar";
     SAVE = "Salvar";
     CLOSE = "Fechar";
     PREFERENCES = "Preferncias";
     ABOUT = "Sobre";
+    PROGRESS = "Progresso";
     EXIT = "Sair";
     CURRENT_FILE = "Arquivo: %s\n";
     NO_FILE = "Arquivo: Nenhum arquivo selecionado";
+    OPERATION_PROGRESS = "Operao: %s %.1f%%\n";
+    OPERATION_CANCELLED = "Operao: Cancelada";
+    INVALID_FILE = "Operao: Arquivo invlido ou no suportado";
+    OPERATION_FAILED = "Operao: Falhou";
+    OPERATION_RUNNING = "Aguarde a operao atual terminar ou cancele-a.";
     OPEN_FILE = "Entre com o nome de arquivo para abrir:";
     IMPORT_FILE = "Entre com o arquivo de objeto para importar:";
     MESHES = "Geometrias:";
@@ -127,8 +162,16 @@ void Translator::setPortugueseLanguage() {
     VERTEX_COUNT = "Contagem de vrtices: %zu\n";
     POLYGON_COUNT = "Contagem de polgonos: %zu\n";
     MESH_COUNT = "Contagem de geometrias: %zu\n";
+    TETRAHEDRON_COUNT = "Contagem de tetraedros: %zu\n";
+    MEMORY_USAGE = "Uso de memria: %.2f MB de %.2f MB reservados\n";
+    PEAK_MEMORY_USAGE = "Memria do processo: %.2f MB, pico de %.2f MB\n";
+    READ_STATISTICS = "ltima leitura: %.2f MB em %.3f s (%.2f MB/s)\n";
     TETRAHEDRALIZE_MESH = "Selecione a geometria para tetraedralizar:";
+    DECIMATE_MESH = "Selecione a geometria para simplificar:";
+    ALL_MESHES = "Todas as geometrias";
     EDGE_RATIO_PARAMETER = "Entre com o parmetro de razo raio aresta:";
+    TARGET_TRIANGLE_COUNT = "Entre com o nmero de tringulos desejado (0 para sem limite):";
+    MAXIMUM_ERROR = "Entre com o erro mximo (0 para sem limite):";
     DELETE_MESH = "Selecione a geometria para deletar:";
     EXPORT_MESH = "Selecione a geometria para exportar:";
     EXPORT_FILE = "Entre com o nome de arquivo para salvar a geometria:";
@@ -141,18 +184,31 @@ void Translator::setPortugueseLanguage() {
     DEFAULT_THEME = "Selecione o tema padro da aplicao:";
     LIGHT = "Claro";
     DARK = "Escuro";
+    DEFAULT_ORDERING = "Selecione a ordenao padro de vrtices para arquivos abertos:";
+    FILE_ORDERING = "Ordem do arquivo";
+    MORTON_ORDERING = "Curva de Morton";
+    HILBERT_ORDERING = "Curva de Hilbert";
     ABOUT_VIRGO = "Virgo oferece um conjunto de recursos interativos para visualizao 3D.";
     DEPENDENCIES = "Dependncias";
     OPENING = "Abrindo...";
     IMPORTING = "Importando...";
     TETRAHEDRALIZING = "Tetraedralizando...";
+    DECIMATING = "Simplificando...";
+    REORDERING = "Reordenando...";
     DELETING = "Deletando...";
     EXPORTING = "Exportando...";
     SAVING = "Salvando...";
+    PREPARING = "Preparando...";
+    STORING = "Armazenando...";
+    CANCELLING = "Cancelando...";
     YES = "SIM";
     NO = "NO";
     OK = "OK";
     CANCEL = "Cancelar";
+    CANCEL_OPERATION = "Cancelar operao";
+    SELF_INTERSECTION = "A malha %s intersecta a si mesma em %zu pares de tringulos:\n";
+    INTERSECTING_FACES = "Faces %zu e %zu\n";
+    MORE_INTERSECTIONS = "E mais %zu\n";
 }
 
 void Translator::setSpanishLanguage() {
@@ -161,15 +217,22 @@ void Translator::setSpanishLanguage() {
     INFORMATION = "Informacin";
     VIEWPORT = "Visualizar";
     TETRAHEDRALIZE = "Tetraedralizar";
+    DECIMATE = "Simplificar";
     DELETE = "Eliminar";
     EXPORT = "Exportar";
     SAVE = "Guardar";
     CLOSE = "Cerrar";
     PREFERENCES = "Preferencias";
     ABOUT = "Acerca de";
+    PROGRESS = "Progreso";
     EXIT = "Salida";
     CURRENT_FILE = "Archivo: %s\n";
     NO_FILE = "Archivo: Ningn archivo seleccionado";
+    OPERATION_PROGRESS = "Operacin: %s %.1f%%\n";
+    OPERATION_CANCELLED = "Operacin: Cancelada";
+    INVALID_FILE = "Operacin: Archivo no vlido o no compatible";
+    OPERATION_FAILED = "Operacin: Fall";
+    OPERATION_RUNNING = "Espere a que termine la operacin actual o canclela.";
     OPEN_FILE = "Introduzca el nombre de archivo para abrir:";
     IMPORT_FILE = "Introduzca el archivo de objeto para importar:";
     MESHES = "Geometras:";
@@ -177,8 +240,16 @@ void Translator::setSpanishLanguage() {
     VERTEX_COUNT = "Recuento de vrtices: %zu\n";
     POLYGON_COUNT = "Recuento de polgonos: %zu\n";
     MESH_COUNT = "Recuento de geometras: %zu\n";
+    TETRAHEDRON_COUNT = "Recuento de tetraedros: %zu\n";
+    MEMORY_USAGE = "Uso de memoria: %.2f MB de %.2f MB reservados\n";
+    PEAK_MEMORY_USAGE = "Memoria del proceso: %.2f MB, pico de %.2f MB\n";
+    READ_STATISTICS = "ltima lectura: %.2f MB en %.3f s (%.2f MB/s)\n";
     TETRAHEDRALIZE_MESH = "Seleccione la geometra para tetraedralizar:";
+    DECIMATE_MESH = "Seleccione la geometra para simplificar:";
+    ALL_MESHES = "Todas las geometras";
     EDGE_RATIO_PARAMETER = "Introduzca el parmetro de relacin radio arista:";
+    TARGET_TRIANGLE_COUNT = "Introduzca el nmero de tringulos deseado (0 para sin lmite):";
+    MAXIMUM_ERROR = "Introduzca el error mximo (0 para sin lmite):";
     DELETE_MESH = "Seleccione la geometra para eliminar:";
     EXPORT_MESH = "Seleccione la geometra para exportar:";
     EXPORT_FILE = "Introduzca el nombre de archivo para guardar la geometra:";
@@ -191,18 +262,31 @@ void Translator::setSpanishLanguage() {
     DEFAULT_THEME = "Seleccione el tema por defecto de la aplicacin:";
     LIGHT = "Claro";
     DARK = "Oscuro";
+    DEFAULT_ORDERING = "Seleccione el orden de vrtices por defecto para archivos abiertos:";
+    FILE_ORDERING = "Orden del archivo";
+    MORTON_ORDERING = "Curva de Morton";
+    HILBERT_ORDERING = "Curva de Hilbert";
     ABOUT_VIRGO = "Virgo proporciona un conjunto de caractersticas interactivas para la visualizacin en 3D.";
     DEPENDENCIES = "Dependencias";
     OPENING = "Abriendo...";
     IMPORTING = "Importando...";
     TETRAHEDRALIZING = "Tetraedralizando...";
+    DECIMATING = "Simplificando...";
+    REORDERING = "Reordenando...";
     DELETING = "Eliminando...";
     EXPORTING = "Exportando...";
     SAVING = "Guardando...";
+    PREPARING = "Preparando...";
+    STORING = "Almacenando...";
+    CANCELLING = "Cancelando...";
     YES = "S";
     NO = "NO";
     OK = "OK";
     CANCEL = "Cancelar";
+    CANCEL_OPERATION = "Cancelar operacin";
+    SELF_INTERSECTION = "La malla %s se interseca a s misma en %zu pares de tringulos:\n";
+    INTERSECTING_FACES = "Caras %zu y %zu\n";
+    MORE_INTERSECTIONS = "Y %zu ms\n";
 }
 
 VIRGO_NAMESPACE_END
\ No newline at end of file
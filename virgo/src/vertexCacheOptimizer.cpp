@@ -0,0 +1,406 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "vertexCacheOptimizer.h"
+#include <algorithm>
+#include <climits>
+
+#define DEFAULT_CACHE_SIZE 16
+#define DEFAULT_OVERDRAW_THRESHOLD 1.05f
+
+VIRGO_NAMESPACE_BEGIN
+
+struct Cluster {
+    size_t begin, end;
+    float key;
+};
+
+static const Vector & getPosition(const Vector * positions, size_t stride, size_t index) {
+    return *(const Vector *)((const char *)positions + index * stride);
+}
+
+static bool isMiss(vector<size_t> & stamps, size_t vertex, size_t & time, size_t cacheSize) {
+    if (time - stamps[vertex] <= cacheSize)
+        return false;
+
+    stamps[vertex] = time++;
+
+    return true;
+}
+
+static bool isGreater(const Cluster & first, const Cluster & second) {
+    return first.key > second.key;
+}
+
+VertexCacheOptimizer::VertexCacheOptimizer() {
+    cacheSize = DEFAULT_CACHE_SIZE;
+    clusterOrdering = true;
+    overdrawThreshold = DEFAULT_OVERDRAW_THRESHOLD;
+    fetchOrdering = true;
+
+    initialCacheMissRatio = 0;
+    cacheMissRatio = 0;
+}
+
+VertexCacheOptimizer::~VertexCacheOptimizer() {}
+
+void VertexCacheOptimizer::setCacheSize(size_t cacheSize) {
+    this->cacheSize = max<size_t>(cacheSize, 3);
+}
+
+size_t VertexCacheOptimizer::getCacheSize() const {
+    return cacheSize;
+}
+
+void VertexCacheOptimizer::setClusterOrdering(bool clusterOrdering) {
+    this->clusterOrdering = clusterOrdering;
+}
+
+bool VertexCacheOptimizer::getClusterOrdering() const {
+    return clusterOrdering;
+}
+
+void VertexCacheOptimizer::setOverdrawThreshold(float overdrawThreshold) {
+    this->overdrawThreshold = max(overdrawThreshold, 1.0f);
+}
+
+float VertexCacheOptimizer::getOverdrawThreshold() const {
+    return overdrawThreshold;
+}
+
+void VertexCacheOptimizer::setFetchOrdering(bool fetchOrdering) {
+    this->fetchOrdering = fetchOrdering;
+}
+
+bool VertexCacheOptimizer::getFetchOrdering() const {
+    return fetchOrdering;
+}
+
+void VertexCacheOptimizer::optimize(unsigned int * indices, size_t indexCount, const Vector * positions,
+    size_t stride, size_t vertexCount) {
+    size_t triangleCount = indexCount / 3;
+
+    remap.clear();
+    clusters.clear();
+
+    initialCacheMissRatio = getCacheMissRatio(indices, indexCount, vertexCount, cacheSize);
+    cacheMissRatio = initialCacheMissRatio;
+
+    if (triangleCount == 0)
+        return;
+
+    buildAdjacency(indices, triangleCount, vertexCount);
+    orderTriangles(indices, triangleCount, vertexCount);
+
+    if (clusterOrdering && positions != nullptr) {
+        splitClusters(indices, vertexCount);
+        sortClusters(indices, triangleCount, positions, stride);
+    }
+
+    vector<unsigned int> ordered(triangleCount * 3);
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        const unsigned int * triangle = indices + order[i] * 3;
+
+        ordered[i * 3] = triangle[0];
+        ordered[i * 3 + 1] = triangle[1];
+        ordered[i * 3 + 2] = triangle[2];
+    }
+
+    copy(ordered.begin(), ordered.end(), indices);
+
+    if (fetchOrdering)
+        orderVertices(indices, triangleCount * 3, vertexCount);
+
+    cacheMissRatio = getCacheMissRatio(indices, indexCount, vertexCount, cacheSize);
+}
+
+const vector<unsigned int> & VertexCacheOptimizer::getRemap() const {
+    return remap;
+}
+
+float VertexCacheOptimizer::getInitialCacheMissRatio() const {
+    return initialCacheMissRatio;
+}
+
+float VertexCacheOptimizer::getCacheMissRatio() const {
+    return cacheMissRatio;
+}
+
+size_t VertexCacheOptimizer::getClusterCount() const {
+    return clusters.size();
+}
+
+float VertexCacheOptimizer::getCacheMissRatio(const unsigned int * indices, size_t indexCount,
+    size_t vertexCount, size_t cacheSize) {
+    if (indexCount < 3)
+        return 0;
+
+    vector<size_t> stamps(vertexCount, 0);
+
+    size_t time = cacheSize + 1;
+    size_t missCount = 0;
+
+    for (size_t i = 0; i < indexCount; i++) {
+        if (isMiss(stamps, indices[i], time, cacheSize))
+            missCount++;
+    }
+
+    return (float)missCount / (indexCount / 3);
+}
+
+void VertexCacheOptimizer::buildAdjacency(const unsigned int * indices, size_t triangleCount,
+    size_t vertexCount) {
+    offsets.assign(vertexCount + 1, 0);
+    adjacency.resize(triangleCount * 3);
+
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        offsets[indices[i] + 1]++;
+
+    for (size_t i = 1; i <= vertexCount; i++)
+        offsets[i] += offsets[i - 1];
+
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        adjacency[offsets[indices[i]]++] = (unsigned int)(i / 3);
+
+    for (size_t i = vertexCount; i > 0; i--)
+        offsets[i] = offsets[i - 1];
+
+    offsets[0] = 0;
+}
+
+void VertexCacheOptimizer::orderTriangles(const unsigned int * indices, size_t triangleCount,
+    size_t vertexCount) {
+    vector<unsigned int> liveCounts(vertexCount);
+    vector<size_t> stamps(vertexCount, 0);
+    vector<char> emitted(triangleCount, 0);
+
+    vector<unsigned int> deadEnds;
+    vector<unsigned int> candidates;
+
+    for (size_t i = 0; i < vertexCount; i++)
+        liveCounts[i] = offsets[i + 1] - offsets[i];
+
+    order.clear();
+    order.reserve(triangleCount);
+    deadEnds.reserve(triangleCount * 3);
+
+    size_t time = cacheSize + 1;
+    size_t cursor = 0;
+    size_t vertex = SIZE_MAX;
+
+    while (true) {
+        if (vertex == SIZE_MAX) {
+            while (!deadEnds.empty() && vertex == SIZE_MAX) {
+                if (liveCounts[deadEnds.back()] > 0)
+                    vertex = deadEnds.back();
+
+                deadEnds.pop_back();
+            }
+
+            while (cursor < vertexCount && vertex == SIZE_MAX) {
+                if (liveCounts[cursor] > 0) {
+                    vertex = cursor;
+                    clusters.push_back((unsigned int)order.size());
+                }
+                else {
+                    cursor++;
+                }
+            }
+
+            if (vertex == SIZE_MAX)
+                break;
+        }
+
+        candidates.clear();
+
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; i++) {
+            unsigned int triangle = adjacency[i];
+
+            if (emitted[triangle])
+                continue;
+
+            for (size_t j = 0; j < 3; j++) {
+                unsigned int corner = indices[triangle * 3 + j];
+
+                deadEnds.push_back(corner);
+                candidates.push_back(corner);
+
+                liveCounts[corner]--;
+                isMiss(stamps, corner, time, cacheSize);
+            }
+
+            emitted[triangle] = 1;
+            order.push_back(triangle);
+        }
+
+        long long bestPriority = -1;
+        vertex = SIZE_MAX;
+
+        for (size_t i = 0; i < candidates.size(); i++) {
+            unsigned int candidate = candidates[i];
+
+            if (liveCounts[candidate] == 0)
+                continue;
+
+            long long priority = 0;
+
+            if (time - stamps[candidate] + liveCounts[candidate] * 2 <= cacheSize)
+                priority = (long long)(time - stamps[candidate]);
+
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                vertex = candidate;
+            }
+        }
+    }
+}
+
+void VertexCacheOptimizer::splitClusters(const unsigned int * indices, size_t vertexCount) {
+    vector<size_t> stamps(vertexCount, 0);
+    vector<unsigned int> boundaries;
+
+    size_t time = cacheSize + 1;
+    size_t triangleCount = order.size();
+
+    clusters.push_back((unsigned int)triangleCount);
+
+    for (size_t i = 0; i + 1 < clusters.size(); i++) {
+        size_t begin = clusters[i];
+        size_t end = clusters[i + 1];
+        size_t missCount = 0;
+
+        time += cacheSize + 1;
+
+        for (size_t j = begin; j < end; j++) {
+            for (size_t k = 0; k < 3; k++)
+                missCount += isMiss(stamps, indices[order[j] * 3 + k], time, cacheSize);
+        }
+
+        float threshold = (float)missCount / (end - begin) * overdrawThreshold;
+
+        size_t first = begin;
+        missCount = 0;
+
+        time += cacheSize + 1;
+        boundaries.push_back((unsigned int)begin);
+
+        for (size_t j = begin; j < end; j++) {
+            for (size_t k = 0; k < 3; k++)
+                missCount += isMiss(stamps, indices[order[j] * 3 + k], time, cacheSize);
+
+            if (j + 1 < end && missCount <= threshold * (j + 1 - first)) {
+                first = j + 1;
+                missCount = 0;
+
+                time += cacheSize + 1;
+                boundaries.push_back((unsigned int)first);
+            }
+        }
+    }
+
+    clusters.swap(boundaries);
+}
+
+void VertexCacheOptimizer::sortClusters(const unsigned int * indices, size_t triangleCount,
+    const Vector * positions, size_t stride) {
+    vector<Cluster> sorted(clusters.size());
+    vector<Vector> centroids(clusters.size()), normals(clusters.size());
+
+    Vector center(0, 0, 0);
+    float totalArea = 0;
+
+    for (size_t i = 0; i < clusters.size(); i++) {
+        size_t end = i + 1 < clusters.size() ? clusters[i + 1] : triangleCount;
+
+        Vector centroid(0, 0, 0), normal(0, 0, 0);
+        float area = 0;
+
+        for (size_t j = clusters[i]; j < end; j++) {
+            const unsigned int * triangle = indices + order[j] * 3;
+
+            const Vector & a = getPosition(positions, stride, triangle[0]);
+            const Vector & b = getPosition(positions, stride, triangle[1]);
+            const Vector & c = getPosition(positions, stride, triangle[2]);
+
+            Vector faceNormal = (b - a).cross(c - a);
+            float faceArea = faceNormal.length();
+
+            centroid += (a + b + c) * (faceArea / 3.0f);
+            normal += faceNormal;
+            area += faceArea;
+        }
+
+        center += centroid;
+        totalArea += area;
+
+        centroids[i] = area > 0 ? centroid / area : centroid;
+        normals[i] = normal.normalized();
+
+        sorted[i].begin = clusters[i];
+        sorted[i].end = end;
+    }
+
+    center = totalArea > 0 ? center / totalArea : center;
+
+    for (size_t i = 0; i < sorted.size(); i++)
+        sorted[i].key = (centroids[i] - center).dot(normals[i]);
+
+    stable_sort(sorted.begin(), sorted.end(), isGreater);
+
+    vector<unsigned int> reordered;
+    reordered.reserve(triangleCount);
+
+    for (size_t i = 0; i < sorted.size(); i++) {
+        clusters[i] = (unsigned int)reordered.size();
+        reordered.insert(reordered.end(), order.begin() + sorted[i].begin, order.begin() + sorted[i].end);
+    }
+
+    order.swap(reordered);
+}
+
+void VertexCacheOptimizer::orderVertices(unsigned int * indices, size_t indexCount, size_t vertexCount) {
+    unsigned int count = 0;
+
+    remap.assign(vertexCount, UINT_MAX);
+
+    for (size_t i = 0; i < indexCount; i++) {
+        unsigned int & target = remap[indices[i]];
+
+        if (target == UINT_MAX)
+            target = count++;
+
+        indices[i] = target;
+    }
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (remap[i] == UINT_MAX)
+            remap[i] = count++;
+    }
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
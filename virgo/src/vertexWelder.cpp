@@ -0,0 +1,514 @@
+// Copyright (c) 2016, Danilo Peixoto and Gabriel Gustavo. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "vertexWelder.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#define MINIMUM_CAPACITY 16
+
+VIRGO_NAMESPACE_BEGIN
+
+struct Cell {
+    int64_t x, y, z;
+};
+
+struct HashTable {
+    HashTable(size_t count) : slots(getCapacity(count)) {
+        mask = slots.size() - 1;
+    }
+
+    static size_t getCapacity(size_t count) {
+        size_t capacity = MINIMUM_CAPACITY;
+
+        while (capacity < count * 2)
+            capacity <<= 1;
+
+        return capacity;
+    }
+
+    vector<atomic<size_t> > slots;
+    size_t mask;
+};
+
+static uint64_t mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDULL;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ULL;
+    value ^= value >> 33;
+
+    return value;
+}
+
+static uint64_t getHash(uint64_t a, uint64_t b, uint64_t c) {
+    return mix(mix(mix(a) ^ b) ^ c);
+}
+
+static int64_t getCoordinate(float value, float tolerance) {
+    if (tolerance > 0)
+        return (int64_t)floor((double)value / tolerance);
+
+    uint32_t bits;
+    value += 0.0f;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    return bits;
+}
+
+static Cell getCell(const Vector & point, float tolerance) {
+    Cell cell;
+
+    cell.x = getCoordinate(point.x, tolerance);
+    cell.y = getCoordinate(point.y, tolerance);
+    cell.z = getCoordinate(point.z, tolerance);
+
+    return cell;
+}
+
+static void getNeighborRange(float value, int64_t coordinate, float cellSize,
+    int64_t & lower, int64_t & upper) {
+    if ((double)value / cellSize - coordinate < 0.5)
+        lower = -1;
+    else
+        upper = 1;
+}
+
+static uint64_t getHash(const Cell & cell) {
+    return getHash((uint64_t)cell.x, (uint64_t)cell.y, (uint64_t)cell.z);
+}
+
+static bool isEqual(const Cell & first, const Cell & second) {
+    return first.x == second.x && first.y == second.y && first.z == second.z;
+}
+
+static void getSortedVertices(const Triangle & triangle, size_t (&vertices)[3]) {
+    vertices[0] = triangle.v1;
+    vertices[1] = triangle.v2;
+    vertices[2] = triangle.v3;
+
+    if (vertices[0] > vertices[1])
+        swap(vertices[0], vertices[1]);
+
+    if (vertices[1] > vertices[2])
+        swap(vertices[1], vertices[2]);
+
+    if (vertices[0] > vertices[1])
+        swap(vertices[0], vertices[1]);
+}
+
+template <typename Equal>
+static size_t insertItem(HashTable & table, size_t item, uint64_t hash, const Equal & equal) {
+    for (size_t slot = hash & table.mask;; slot = (slot + 1) & table.mask) {
+        size_t current = table.slots[slot].load();
+
+        if (current == 0 && table.slots[slot].compare_exchange_strong(current, item + 1))
+            return slot;
+
+        if (!equal(current - 1))
+            continue;
+
+        while (item + 1 < current && !table.slots[slot].compare_exchange_weak(current, item + 1));
+
+        return slot;
+    }
+}
+
+template <typename Equal>
+static bool findItem(const HashTable & table, uint64_t hash, const Equal & equal, size_t & slot) {
+    for (slot = hash & table.mask;; slot = (slot + 1) & table.mask) {
+        size_t current = table.slots[slot].load();
+
+        if (current == 0)
+            return false;
+
+        if (equal(current - 1))
+            return true;
+    }
+}
+
+static void markVertices(const Mesh * mesh, vector<char> & vertices) {
+    const Triangle * triangle = mesh->getTriangleData();
+
+    for (size_t i = 0; i < mesh->getTriangleCount(); i++, triangle++) {
+        vertices[triangle->v1 - 1] = 1;
+        vertices[triangle->v2 - 1] = 1;
+        vertices[triangle->v3 - 1] = 1;
+    }
+}
+
+static void markTetrahedra(const Mesh * mesh, vector<char> & vertices) {
+    const Tetrahedron * tetrahedron = mesh->volume.getTetrahedronData();
+
+    for (size_t i = 0; i < mesh->volume.getTetrahedronCount(); i++, tetrahedron++) {
+        vertices[tetrahedron->v1 - 1] = 1;
+        vertices[tetrahedron->v2 - 1] = 1;
+        vertices[tetrahedron->v3 - 1] = 1;
+        vertices[tetrahedron->v4 - 1] = 1;
+    }
+}
+
+static void remapMesh(Mesh * mesh, const vector<size_t> & indices, size_t threadCount) {
+    Triangle * triangles = mesh->triangles.data();
+    Tetrahedron * tetrahedra = mesh->volume.tetrahedra.data();
+
+    parallelFor(mesh->getTriangleCount(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            Triangle & triangle = triangles[i];
+
+            triangle.v1 = indices[triangle.v1 - 1] + 1;
+            triangle.v2 = indices[triangle.v2 - 1] + 1;
+            triangle.v3 = indices[triangle.v3 - 1] + 1;
+        }
+    }, threadCount);
+
+    parallelFor(mesh->volume.getTetrahedronCount(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            Tetrahedron & tetrahedron = tetrahedra[i];
+
+            tetrahedron.v1 = indices[tetrahedron.v1 - 1] + 1;
+            tetrahedron.v2 = indices[tetrahedron.v2 - 1] + 1;
+            tetrahedron.v3 = indices[tetrahedron.v3 - 1] + 1;
+            tetrahedron.v4 = indices[tetrahedron.v4 - 1] + 1;
+        }
+    }, threadCount);
+}
+
+VertexWelder::VertexWelder() {
+    tolerance = 0;
+    threadCount = 0;
+
+    removedVertexCount = 0;
+    degenerateCount = 0;
+    duplicateCount = 0;
+}
+
+VertexWelder::~VertexWelder() {}
+
+void VertexWelder::setTolerance(float tolerance) {
+    this->tolerance = tolerance > 0 ? tolerance : 0;
+}
+
+float VertexWelder::getTolerance() const {
+    return tolerance;
+}
+
+void VertexWelder::setThreadCount(size_t threadCount) {
+    this->threadCount = threadCount;
+}
+
+size_t VertexWelder::getThreadCount() const {
+    return threadCount;
+}
+
+void VertexWelder::weldGeometry(Geometry * geometry) {
+    weldRange(geometry, 0, geometry->getMeshCount());
+}
+
+void VertexWelder::weldMesh(Geometry * geometry, size_t index) {
+    weldRange(geometry, index, min(index + 1, geometry->getMeshCount()));
+}
+
+const vector<size_t> & VertexWelder::getRemap() const {
+    return remap;
+}
+
+size_t VertexWelder::getRemovedVertexCount() const {
+    return removedVertexCount;
+}
+
+size_t VertexWelder::getDegenerateCount() const {
+    return degenerateCount;
+}
+
+size_t VertexWelder::getDuplicateCount() const {
+    return duplicateCount;
+}
+
+void VertexWelder::weldRange(Geometry * geometry, size_t first, size_t last) {
+    size_t vertexCount = geometry->getVertexCount();
+    size_t workerCount = threadCount != 0 ? threadCount : virgo::getThreadCount();
+
+    removedVertexCount = 0;
+    degenerateCount = 0;
+    duplicateCount = 0;
+
+    vector<char> candidates(vertexCount, 0);
+    vector<char> referenced(vertexCount, 0);
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
+        const Mesh * mesh = geometry->getMeshByIndex(i);
+
+        if (i >= first && i < last) {
+            markVertices(mesh, candidates);
+        }
+        else {
+            markVertices(mesh, referenced);
+            markTetrahedra(mesh, referenced);
+        }
+    }
+
+    clusterVertices(geometry, candidates, workerCount);
+
+    vector<size_t> positions(vertexCount);
+    size_t count = 0;
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (remap[i] != i && !referenced[i])
+            positions[i] = SIZE_MAX;
+        else
+            positions[i] = count++;
+    }
+
+    removedVertexCount = vertexCount - count;
+
+    parallelFor(vertexCount, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            remap[i] = positions[remap[i]];
+    }, workerCount);
+
+    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
+        Mesh * mesh = geometry->getMeshByIndex(i);
+
+        if (i >= first && i < last) {
+            remapMesh(mesh, remap, workerCount);
+            removeTriangles(mesh, workerCount);
+
+            geometry->invalidateMesh(i);
+        }
+        else {
+            remapMesh(mesh, positions, workerCount);
+        }
+    }
+
+    if (removedVertexCount == 0)
+        return;
+
+    Vector * points = geometry->points.data();
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (positions[i] != SIZE_MAX)
+            points[positions[i]] = points[i];
+    }
+
+    geometry->points.resize(count);
+}
+
+void VertexWelder::clusterVertices(const Geometry * geometry, const vector<char> & candidates,
+    size_t workerCount) {
+    size_t vertexCount = geometry->getVertexCount();
+    const Vector * points = geometry->getPointData();
+
+    remap.resize(vertexCount);
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+            remap[i] = i;
+    }, workerCount);
+
+    size_t candidateCount = count(candidates.begin(), candidates.end(), 1);
+
+    if (candidateCount == 0)
+        return;
+
+    HashTable table(candidateCount);
+    vector<size_t> cells(vertexCount);
+
+    float cellSize = tolerance * 2.0f;
+
+    parallelFor(vertexCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            if (!candidates[i])
+                continue;
+
+            Cell cell = getCell(points[i], cellSize);
+
+            cells[i] = insertItem(table, i, getHash(cell), [&](size_t other) {
+                return isEqual(getCell(points[other], cellSize), cell);
+            });
+        }
+    }, workerCount);
+
+    if (tolerance == 0) {
+        parallelFor(vertexCount, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                if (candidates[i])
+                    remap[i] = table.slots[cells[i]].load() - 1;
+            }
+        }, workerCount);
+
+        return;
+    }
+
+    vector<size_t> offsets(table.slots.size() + 1, 0);
+    vector<size_t> members(candidateCount);
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (candidates[i])
+            offsets[cells[i] + 1]++;
+    }
+
+    for (size_t i = 1; i < offsets.size(); i++)
+        offsets[i] += offsets[i - 1];
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (candidates[i])
+            members[offsets[cells[i]]++] = i;
+    }
+
+    for (size_t i = offsets.size() - 1; i > 0; i--)
+        offsets[i] = offsets[i - 1];
+
+    offsets[0] = 0;
+
+    float squaredTolerance = tolerance * tolerance;
+
+    parallelFor(table.slots.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            if (offsets[i] == offsets[i + 1])
+                continue;
+
+            Cell cell = getCell(points[members[offsets[i]]], cellSize);
+
+            int64_t lowerX = 0, lowerY = 0, lowerZ = 0;
+            int64_t upperX = 0, upperY = 0, upperZ = 0;
+
+            for (size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+                const Vector & point = points[members[j]];
+
+                getNeighborRange(point.x, cell.x, cellSize, lowerX, upperX);
+                getNeighborRange(point.y, cell.y, cellSize, lowerY, upperY);
+                getNeighborRange(point.z, cell.z, cellSize, lowerZ, upperZ);
+            }
+
+            for (int64_t x = lowerX; x <= upperX; x++) {
+                for (int64_t y = lowerY; y <= upperY; y++) {
+                    for (int64_t z = lowerZ; z <= upperZ; z++) {
+                        Cell neighbor = { cell.x + x, cell.y + y, cell.z + z };
+                        size_t slot = 0;
+
+                        bool found = findItem(table, getHash(neighbor), [&](size_t other) {
+                            return isEqual(getCell(points[other], cellSize), neighbor);
+                        }, slot);
+
+                        if (!found)
+                            continue;
+
+                        for (size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+                            size_t vertex = members[j];
+                            size_t nearest = remap[vertex];
+
+                            for (size_t k = offsets[slot]; k < offsets[slot + 1]; k++) {
+                                size_t other = members[k];
+
+                                if (other < nearest && (points[other] - points[vertex]).length2() <= squaredTolerance)
+                                    nearest = other;
+                            }
+
+                            remap[vertex] = nearest;
+                        }
+                    }
+                }
+            }
+        }
+    }, workerCount);
+
+    vector<size_t> & next = cells;
+    atomic<bool> changed(true);
+
+    while (changed) {
+        changed = false;
+
+        parallelFor(vertexCount, [&](size_t first, size_t last) {
+            bool localChanged = false;
+
+            for (size_t i = first; i < last; i++) {
+                next[i] = remap[remap[i]];
+                localChanged |= next[i] != remap[i];
+            }
+
+            if (localChanged)
+                changed = true;
+        }, workerCount);
+
+        remap.swap(next);
+    }
+}
+
+void VertexWelder::removeTriangles(Mesh * mesh, size_t workerCount) {
+    size_t triangleCount = mesh->getTriangleCount();
+    Triangle * triangles = mesh->triangles.data();
+
+    HashTable table(triangleCount);
+    vector<size_t> slots(triangleCount, SIZE_MAX);
+
+    parallelFor(triangleCount, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            const Triangle & triangle = triangles[i];
+
+            if (triangle.v1 == triangle.v2 || triangle.v2 == triangle.v3 || triangle.v3 == triangle.v1)
+                continue;
+
+            size_t vertices[3];
+            getSortedVertices(triangle, vertices);
+
+            slots[i] = insertItem(table, i, getHash(vertices[0], vertices[1], vertices[2]),
+                [&](size_t other) {
+                size_t otherVertices[3];
+                getSortedVertices(triangles[other], otherVertices);
+
+                return vertices[0] == otherVertices[0] && vertices[1] == otherVertices[1]
+                    && vertices[2] == otherVertices[2];
+            });
+        }
+    }, workerCount);
+
+    size_t count = 0;
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        if (slots[i] == SIZE_MAX) {
+            degenerateCount++;
+            continue;
+        }
+
+        if (table.slots[slots[i]].load() - 1 != i) {
+            duplicateCount++;
+            continue;
+        }
+
+        triangles[count++] = triangles[i];
+    }
+
+    mesh->triangles.resize(count);
+}
+
+VIRGO_NAMESPACE_END
\ No newline at end of file
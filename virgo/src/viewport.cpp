@@ -26,6 +26,11 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "viewport.h"
+#include "offscreenContext.h"
+#include "timer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <GL\freeglut.h>
 #include <GL\GL.h>
 #include <GL\GLU.h>
@@ -34,9 +39,72 @@ VIRGO_NAMESPACE_BEGIN
 
 Viewport * Viewport::instance = nullptr;
 
+CameraKey::CameraKey(const Vector & motion, const Vector & rotation)
+    : motion(motion), rotation(rotation) {}
+
+CameraKey::~CameraKey() {}
+
+BenchmarkSettings::BenchmarkSettings() {
+    width = 800;
+    height = 500;
+
+    frameCount = 240;
+    warmupCount = 10;
+}
+
+BenchmarkSettings::~BenchmarkSettings() {}
+
+bool BenchmarkSettings::loadCameraPath(const char * filename) {
+    FILE * file = fopen(filename, "r");
+
+    if (file == nullptr)
+        return false;
+
+    vector<CameraKey> path;
+    CameraKey key;
+
+    while (fscanf(file, "%f %f %f %f %f", &key.motion.x, &key.motion.y, &key.motion.z,
+        &key.rotation.x, &key.rotation.y) == 5)
+        path.push_back(key);
+
+    bool status = feof(file) != 0 && !path.empty();
+
+    fclose(file);
+
+    if (status)
+        cameraPath.swap(path);
+
+    return status;
+}
+
+FrameStatistics::FrameStatistics() {
+    frameCount = 0;
+    triangleCount = 0;
+
+    totalTime = 0;
+    minimumTime = 0;
+    medianTime = 0;
+    percentile90Time = 0;
+    percentile99Time = 0;
+    maximumTime = 0;
+
+    initialCacheMissRatio = 0;
+    cacheMissRatio = 0;
+}
+
+FrameStatistics::~FrameStatistics() {}
+
+double FrameStatistics::getFrameRate() const {
+    return totalTime > 0 ? frameCount / totalTime : 0;
+}
+
+double FrameStatistics::getTriangleRate() const {
+    return totalTime > 0 ? (double)triangleCount * frameCount / totalTime : 0;
+}
+
 Viewport::Viewport() {
     window = -1;
-    object = -1;
+    geometry = nullptr;
 
     windowWidth = 800;
     windowHeight = 500;
@@ -72,7 +140,9 @@ void Viewport::show() {
 
     window = glutCreateWindow("Viewport");
 
-    initialize();
+    glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_CONTINUE_EXECUTION);
+
+    initialize((RendererLoader)glutGetProcAddress);
 
     glutDisplayFunc(displayCallback);
     glutReshapeFunc(reshapeCallback);
@@ -88,9 +158,8 @@ void Viewport::show() {
 }
 
 void Viewport::close() {
-    if (object != -1)
-        glDeleteLists(object, 1);
-    
+    renderer.release();
+
     if (window != -1)
         glutLeaveMainLoop();
 }
@@ -101,53 +170,18 @@ void Viewport::loadGeometry(const Geometry * geometry) {
     setDefaultViewport();
 }
 
-void Viewport::initialize() {
-    glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_CONTINUE_EXECUTION);
-
+void Viewport::initialize(RendererLoader loader) {
     glEnable(GL_DEPTH_TEST);
     glEnable(GLUT_MULTISAMPLE);
-    glShadeModel(GL_FLAT);
+    glShadeModel(GL_SMOOTH);
 
     glClearColor(0.35, 0.35, 0.35, 1.0);
+
+    renderer.initialize(loader);
 }
 
 void Viewport::loadObject() {
-    if (geometry == nullptr)
-        return;
-
-    if (object != -1)
-        glDeleteLists(object, 1);
-
-    object = glGenLists(1);
-
-    glNewList(object, GL_COMPILE);
-    glBegin(GL_TRIANGLES);
-
-    Mesh * mesh = nullptr;
-    Vector * points[3] = { nullptr };
-
-    Vector normal;
-
-    for (size_t i = 0; i < geometry->getMeshCount(); i++) {
-        mesh = geometry->getMeshByIndex(i);
-
-        for (size_t j = 0; j < mesh->triangles.size(); j++) {
-            points[0] = geometry->points[mesh->triangles[j]->v1 - 1];
-            points[1] = geometry->points[mesh->triangles[j]->v2 - 1];
-            points[2] = geometry->points[mesh->triangles[j]->v3 - 1];
-
-            normal = (*points[1] - *points[0]).cross(*points[2] - *points[0]).normalize();
-
-            glNormal3f(normal.x, normal.y, normal.z);
-            glVertex3f(points[0]->x, points[0]->y, points[0]->z);
-            glVertex3f(points[1]->x, points[1]->y, points[1]->z);
-            glVertex3f(points[2]->x, points[2]->y, points[2]->z);
-        }
-    }
-
-    glEnd();
-    glEndList();
-    glFlush();
+    renderer.load(geometry);
 }
 
 void Viewport::drawObject() {
@@ -159,7 +193,7 @@ void Viewport::drawObject() {
         glPolygonOffset(1.0, 1.0);
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-        glCallList(object);
+        renderer.draw();
     }
 
     if (enableWireframe) {
@@ -171,7 +205,7 @@ void Viewport::drawObject() {
         glColor4f(0, 0, 0.35, 1.0);
         glLineWidth(1.0);
 
-        glCallList(object);
+        renderer.draw();
     }
 }
 
@@ -214,7 +248,16 @@ void Viewport::setDefaultViewport() {
     mouseRotation = Vector(0, 0, 0);
 }
 
-void Viewport::display() {
+void Viewport::setProjection(int width, int height) {
+    glMatrixMode(GL_PROJECTION);
+
+    glViewport(0, 0, width, height);
+
+    glLoadIdentity();
+    gluPerspective(45.0, width / (float)height, 0.001, 1000.0);
+}
+
+void Viewport::render() {
     Vector axis;
     float viewMatrix[16];
 
@@ -234,17 +277,154 @@ void Viewport::display() {
 
     drawGrid(10);
     drawObject();
+}
 
-    glutSwapBuffers();
+bool Viewport::benchmark(const BenchmarkSettings & settings, FrameStatistics & statistics) {
+    statistics = FrameStatistics();
+
+    if (settings.width <= 0 || settings.height <= 0 || settings.frameCount == 0)
+        return false;
+
+    OffscreenContext context;
+
+    if (!context.create(settings.width, settings.height))
+        return false;
+
+    Vector motion = mouseMotion;
+    Vector rotation = mouseRotation;
+
+    initialize(OffscreenContext::getProcedure);
+    loadObject();
+    setProjection(settings.width, settings.height);
+
+    vector<CameraKey> path = settings.cameraPath.empty() ? createOrbitPath() : settings.cameraPath;
+    vector<double> frameTimes(settings.frameCount);
+
+    bool status = true;
+    char suffix[32];
+    Timer timer;
+
+    for (size_t i = 0; i < settings.warmupCount + settings.frameCount; i++) {
+        size_t frame = i < settings.warmupCount ? 0 : i - settings.warmupCount;
+        CameraKey key = getCameraKey(path, frame, settings.frameCount);
+
+        mouseMotion = key.motion;
+        mouseRotation = key.rotation;
+
+        timer.reset();
+
+        render();
+        glFinish();
+
+        if (i < settings.warmupCount)
+            continue;
+
+        frameTimes[frame] = timer.getElapsedTime();
+
+        if (!settings.imagePrefix.empty()) {
+            snprintf(suffix, sizeof(suffix), "%04zu.ppm", frame);
+            status = writeImage(settings.imagePrefix + suffix, settings.width, settings.height) && status;
+        }
+    }
+
+    statistics.frameCount = settings.frameCount;
+    statistics.triangleCount = getDrawnTriangleCount();
+    statistics.initialCacheMissRatio = renderer.getInitialCacheMissRatio();
+    statistics.cacheMissRatio = renderer.getCacheMissRatio();
+
+    for (size_t i = 0; i < frameTimes.size(); i++)
+        statistics.totalTime += frameTimes[i];
+
+    sort(frameTimes.begin(), frameTimes.end());
+
+    size_t last = frameTimes.size() - 1;
+
+    statistics.minimumTime = frameTimes.front();
+    statistics.medianTime = frameTimes[last / 2];
+    statistics.percentile90Time = frameTimes[(size_t)ceil(last * 0.9)];
+    statistics.percentile99Time = frameTimes[(size_t)ceil(last * 0.99)];
+    statistics.maximumTime = frameTimes.back();
+
+    renderer.release();
+    context.destroy();
+
+    mouseMotion = motion;
+    mouseRotation = rotation;
+
+    return status;
 }
 
-void Viewport::reshape(int width, int height) {
-    glMatrixMode(GL_PROJECTION);
+CameraKey Viewport::getCameraKey(const vector<CameraKey> & path, size_t frame, size_t frameCount) const {
+    if (path.size() == 1 || frameCount < 2)
+        return path.front();
 
-    glViewport(0, 0, width, height);
+    double position = (double)frame / (frameCount - 1) * (path.size() - 1);
+    size_t index = min((size_t)position, path.size() - 2);
+    float weight = (float)(position - index);
 
-    glLoadIdentity();
-    gluPerspective(45.0, width / (float)height, 0.001, 1000.0);
+    const CameraKey & first = path[index];
+    const CameraKey & second = path[index + 1];
+
+    return CameraKey(first.motion + (second.motion - first.motion) * weight,
+        first.rotation + (second.rotation - first.rotation) * weight);
+}
+
+vector<CameraKey> Viewport::createOrbitPath() const {
+    float radius = 1.0;
+
+    if (geometry != nullptr) {
+        const Vector * point = geometry->getPointData();
+
+        for (size_t i = 0; i < geometry->getVertexCount(); i++, point++)
+            radius = max(radius, point->length());
+    }
+
+    vector<CameraKey> path;
+
+    for (int i = 0; i <= 4; i++)
+        path.push_back(CameraKey(Vector(0, 0, -radius * 3.0f), Vector(i * 90.0f, 20.0f, 0)));
+
+    return path;
+}
+
+size_t Viewport::getDrawnTriangleCount() const {
+    size_t passCount = (enableShade ? 1 : 0) + (enableWireframe ? 1 : 0);
+
+    return renderer.getIndexCount() / 3 * passCount;
+}
+
+bool Viewport::writeImage(const string & filename, int width, int height) const {
+    vector<unsigned char> pixels((size_t)width * height * 3);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    FILE * file = fopen(filename.c_str(), "wb");
+
+    if (file == nullptr)
+        return false;
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+
+    size_t rowSize = (size_t)width * 3;
+    bool status = true;
+
+    for (int i = height - 1; i >= 0; i--)
+        status = fwrite(&pixels[i * rowSize], 1, rowSize, file) == rowSize && status;
+
+    fclose(file);
+
+    return status;
+}
+
+void Viewport::display() {
+    render();
+
+    glutSwapBuffers();
+}
+
+void Viewport::reshape(int width, int height) {
+    setProjection(width, height);
 
     glutPostRedisplay();
 }